@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace elvoiddb::bench {
+
+/* ─── Options: parsed from the command line ────────────────── */
+struct Options {
+    std::vector<size_t> widths{16, 64, 256};   // row payload bytes
+    std::vector<size_t> pages {256};           // data pages per table
+    std::vector<size_t> pools {64};            // buffer-pool frames
+    std::vector<size_t> threads{1, 2, 4, 8, 16, 32};
+    size_t              repeat{3};             // best-of-N timing
+    std::string         filter;                // substring match on bench name
+    std::string         format{"csv"};         // csv | json
+};
+
+/* ─── Result: one measured configuration ───────────────────── */
+struct Result {
+    std::string                                      name;
+    std::vector<std::pair<std::string, std::string>> params;
+    uint64_t                                         ops{0};
+    double                                           seconds{0};
+    std::vector<std::pair<std::string, double>>      metrics{};   // e.g. hit_ratio
+};
+
+class Reporter {
+    std::vector<Result> results_;
+public:
+    void add(Result r) { results_.push_back(std::move(r)); }
+    void print(const std::string& format) const;
+};
+
+/* ─── registry: every bench source file registers itself ──── */
+using BenchFn = void (*)(const Options&, Reporter&);
+
+struct Registrar {
+    Registrar(const char* name, BenchFn fn);
+};
+
+#define ELVOIDDB_BENCH(id)                                              \
+    static void id(const ::elvoiddb::bench::Options&,                   \
+                   ::elvoiddb::bench::Reporter&);                       \
+    static ::elvoiddb::bench::Registrar id##_reg{#id, &id};             \
+    static void id
+
+/* ─── helpers ──────────────────────────────────────────────── */
+
+// run fn() `repeat` times and return the fastest wall time in seconds
+template <typename F>
+double timeBest(size_t repeat, F&& fn)
+{
+    double best = 0;
+    for (size_t i = 0; i < repeat; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        if (i == 0 || dt.count() < best) best = dt.count();
+    }
+    return best;
+}
+
+// as above, but runs setup() untimed before every repetition
+template <typename S, typename F>
+double timeBest(size_t repeat, S&& setup, F&& fn)
+{
+    double best = 0;
+    for (size_t i = 0; i < repeat; ++i) {
+        setup();
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        if (i == 0 || dt.count() < best) best = dt.count();
+    }
+    return best;
+}
+
+// row of four columns whose payload adds up to roughly `width` bytes
+std::vector<std::string> makeRow(size_t width, uint64_t seq);
+
+// unique table name so repeated runs never alias cached frames
+std::string freshTable(const char* prefix);
+
+} // namespace elvoiddb::bench
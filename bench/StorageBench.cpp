@@ -0,0 +1,908 @@
+#include "Aggregate.hpp"
+#include "Bench.hpp"
+#include "BufferPool.hpp"
+#include "CsvReader.hpp"
+#include "Index.hpp"
+#include "IoBackend.hpp"
+#include "Join.hpp"
+#include "ParallelScan.hpp"
+#include "Simd.hpp"
+#include "Storage.hpp"
+#include "ThreadPool.hpp"
+#include "VectorScan.hpp"
+#include "Wal.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <unistd.h>
+
+using namespace elvoiddb::storage;
+
+namespace elvoiddb::bench {
+
+static std::pair<std::string, std::string> P(const char* k, size_t v)
+{
+    return {k, std::to_string(v)};
+}
+
+static const std::vector<std::string> kCols{"c0", "c1", "c2", "c3"};
+
+// makeRow encoded for a table created with kCols (all TEXT)
+static std::string encodeRow(size_t width, uint64_t seq)
+{
+    static const Schema schema = Schema::fromDefs(kCols);
+    std::string rec;
+    schema.encode(makeRow(width, seq), rec, Literal::Csv);
+    return rec;
+}
+
+// fill pg with encoded rows; returns how many fitted
+static size_t fillPage(Page& pg, size_t width, uint64_t& seq)
+{
+    size_t n = 0;
+    while (pg.insertRecord(encodeRow(width, seq)) != -1) { ++seq; ++n; }
+    return n;
+}
+
+// table with `pages` full data pages, written straight through BlockFile
+static std::string buildTable(size_t width, size_t pages, size_t& rows)
+{
+    std::string name = freshTable("scan");
+    TableFile tf(name, true, kCols);
+    uint64_t seq = 0;
+    rows = 0;
+    for (size_t p = 1; p <= pages; ++p) {
+        Page pg;
+        rows += fillPage(pg, width, seq);
+        tf.bf().writePage(p, pg);
+    }
+    gBufPool.flushAll();                              // make pageCount() see every page
+    return name;
+}
+
+// plain zero-filled file of `pages` pages for raw pool benchmarks
+static FileId buildRawFile(size_t pages)
+{
+    std::string name = freshTable("raw") + ".tbl";
+    {
+        std::ofstream f(name, std::ios::binary);
+        std::string zero(PAGE_SIZE, '\0');
+        for (size_t p = 0; p < pages; ++p) f.write(zero.data(), zero.size());
+    }
+    return gHandles.open(name, false);
+}
+
+/* ─── Page ──────────────────────────────────────────────────── */
+
+ELVOIDDB_BENCH(page_insert)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        std::vector<std::string> recs;
+        uint64_t seq = 0;
+        for (size_t i = 0; i < 256; ++i) recs.push_back(encodeRow(w, seq++));
+
+        uint64_t ops = 0;
+        double s = timeBest(opt.repeat, [&] {
+            ops = 0;
+            for (size_t p = 0; p < pages; ++p) {
+                Page pg;
+                size_t i = 0;
+                while (pg.insertRecord(recs[i++ % recs.size()]) != -1) ++ops;
+            }
+        });
+        rep.add({"page_insert", {P("width", w), P("pages", pages)}, ops, s});
+    }
+}
+
+ELVOIDDB_BENCH(page_for_each)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        std::vector<Page> pgs(pages);
+        uint64_t seq = 0, ops = 0;
+        for (auto& pg : pgs) ops += fillPage(pg, w, seq);
+
+        volatile uint64_t sink = 0;
+        double s = timeBest(opt.repeat, [&] {
+            uint64_t sum = 0;
+            for (const auto& pg : pgs)
+                pg.forEachRecord([&](const char*, uint16_t len) { sum += len; });
+            sink = sink + sum;
+        });
+        rep.add({"page_for_each", {P("width", w), P("pages", pages)}, ops, s});
+    }
+}
+
+/* ─── TableFile ─────────────────────────────────────────────── */
+
+ELVOIDDB_BENCH(table_append)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        Page probe;
+        uint64_t seq = 0;
+        uint64_t rows = fillPage(probe, w, seq) * pages;
+
+        std::unique_ptr<TableFile> tf;
+        double s = timeBest(opt.repeat,
+            [&] { tf = std::make_unique<TableFile>(freshTable("append"), true,
+                                                   kCols); },
+            [&] { for (uint64_t i = 0; i < rows; ++i) tf->appendRow(makeRow(w, i)); });
+        rep.add({"table_append", {P("width", w), P("pages", pages), P("pool", gBufPool.capacity())},
+                 rows, s});
+    }
+}
+
+// multi-row INSERT: the same rows handed over `batch` at a time
+ELVOIDDB_BENCH(table_append_rows)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) for (size_t batch : {1, 16, 256}) {
+        Page probe;
+        uint64_t seq = 0;
+        uint64_t rows = fillPage(probe, w, seq) * pages;
+
+        std::unique_ptr<TableFile> tf;
+        double s = timeBest(opt.repeat,
+            [&] { tf = std::make_unique<TableFile>(freshTable("append"), true,
+                                                   kCols); },
+            [&] {
+                std::vector<std::vector<std::string>> chunk;
+                for (uint64_t i = 0; i < rows; i += batch) {
+                    chunk.clear();
+                    for (uint64_t j = i; j < std::min<uint64_t>(rows, i + batch); ++j)
+                        chunk.push_back(makeRow(w, j));
+                    tf->appendRows(chunk);
+                }
+            });
+        rep.add({"table_append_rows", {P("width", w), P("pages", pages), P("batch", batch)}, rows, s});
+    }
+}
+
+// COPY path: same rows as table_append, parsed from a CSV file and
+// written as whole pages around the pool
+ELVOIDDB_BENCH(table_copy)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        Page probe;
+        uint64_t seq = 0;
+        uint64_t rows = fillPage(probe, w, seq) * pages;
+
+        std::string csv = freshTable("copy") + ".csv";
+        {
+            std::ofstream f(csv, std::ios::binary);
+            for (uint64_t i = 0; i < rows; ++i) {
+                auto row = makeRow(w, i);
+                f << row[0] << ',' << row[1] << ',' << row[2] << ',' << row[3] << '\n';
+            }
+        }
+
+        std::unique_ptr<TableFile> tf;
+        double s = timeBest(opt.repeat,
+            [&] { tf = std::make_unique<TableFile>(freshTable("copyt"), true,
+                                                   kCols); },
+            [&] {
+                elvoiddb::util::CsvReader in(csv, ',');
+                std::vector<std::string_view> fields;
+                tf->bulkAppend([&](std::string& rec) {
+                    if (!in.next(fields)) return false;
+                    tf->schema().encode(fields, rec, Literal::Csv);
+                    return true;
+                });
+            });
+        rep.add({"table_copy", {P("width", w), P("pages", pages)}, rows, s});
+    }
+}
+
+ELVOIDDB_BENCH(table_scan)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        size_t rows = 0;
+        TableFile tf(buildTable(w, pages, rows), false);
+
+        double s = timeBest(opt.repeat, [&] {
+            std::vector<std::vector<std::string>> dest;
+            tf.loadAllRows(dest);
+        });
+        rep.add({"table_scan", {P("width", w), P("pages", pages), P("pool", gBufPool.capacity())},
+                 rows, s});
+    }
+}
+
+// same table through TableScan row views: nothing materialized
+ELVOIDDB_BENCH(table_scan_iter)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        size_t rows = 0;
+        TableFile tf(buildTable(w, pages, rows), false);
+
+        volatile uint64_t sink = 0;
+        double s = timeBest(opt.repeat, [&] {
+            TableScan scan(tf);
+            RowRef   row;
+            uint64_t sum = 0;
+            while (scan.next(row)) sum += row.getText(1).size();
+            sink = sink + sum;
+        });
+        rep.add({"table_scan_iter", {P("width", w), P("pages", pages), P("pool", gBufPool.capacity())},
+                 rows, s});
+    }
+}
+
+// (id INT64, price DOUBLE, name TEXT) with ids 0..rows-1, about `pages`
+// row-format pages' worth; returns the row count
+static uint64_t fillTyped(TableFile& tf, size_t width, size_t pages)
+{
+    const uint64_t rows = pages * (PAGE_SIZE / (width + 24));
+    uint64_t seq = 0;
+    tf.bulkAppend([&](std::string& rec) {
+        if (seq == rows) return false;
+        tf.schema().encode(std::vector<std::string>{std::to_string(seq), std::to_string(seq % 1000) + ".25",
+                                                    makeRow(width, seq)[1]},
+                           rec, Literal::Csv);
+        ++seq;
+        return true;
+    });
+    return rows;
+}
+
+static const std::vector<std::string> kTypedCols{"id INT64", "price DOUBLE", "name TEXT"};
+
+// SELECT * … WHERE id < rows * pct / 100: the predicate runs on the record
+// bytes inside the scan, only matching rows are formatted
+ELVOIDDB_BENCH(table_scan_where)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages)
+    for (PageLayout layout : {PageLayout::Slotted, PageLayout::Pax}) {
+        TableFile tf(freshTable("where"), true, kTypedCols, layout);
+        const uint64_t rows = fillTyped(tf, w, pages);
+
+        for (size_t pct : {1, 10, 100}) {
+            Value bound{Value::Kind::Number, std::to_string(rows * pct / 100)};
+            auto where = Predicate::compare("id", CmpOp::Lt, bound);
+            where->bind(tf.schema());
+
+            volatile size_t sink = 0;
+            double s = timeBest(opt.repeat, [&] {
+                TableScan   scan(tf, where.get());
+                RowRef      row;
+                std::string line;
+                while (scan.next(row)) {
+                    line.clear();
+                    for (size_t i = 0; i < row.size(); ++i) row.format(i, line);
+                    sink = sink + line.size();
+                }
+            });
+            rep.add({"table_scan_where", {P("width", w), P("pages", pages),
+                                          {"layout", layout == PageLayout::Pax ? "pax" : "row"},
+                                          P("selectivity_pct", pct)},
+                     rows, s});
+        }
+    }
+}
+
+// table_scan_where at 10% selectivity as a ParallelScan: morsels
+// filtered and formatted by `threads` threads (the caller + pool workers)
+ELVOIDDB_BENCH(parallel_scan)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages)
+    for (PageLayout layout : {PageLayout::Slotted, PageLayout::Pax}) {
+        TableFile tf(freshTable("parallel"), true, kTypedCols, layout);
+        const uint64_t rows = fillTyped(tf, w, pages);
+        auto where = Predicate::compare("id", CmpOp::Lt, {Value::Kind::Number, std::to_string(rows / 10)});
+        where->bind(tf.schema());
+
+        for (size_t nt : opt.threads) {
+            ParallelScan scan(tf, where.get(), nt);
+            struct alignas(64) Count { size_t bytes = 0; };   // per worker, own cache line
+            std::vector<Count> counts(scan.threads());
+            volatile size_t sink = 0;
+            double s = timeBest(opt.repeat, [&] {
+                scan.run([&](size_t worker, size_t, TableScan& morsel) {
+                    RowRef      row;
+                    std::string line;
+                    while (morsel.next(row)) {
+                        line.clear();
+                        for (size_t i = 0; i < row.size(); ++i) row.format(i, line);
+                        counts[worker].bytes += line.size();
+                    }
+                });
+                for (const Count& c : counts) sink = sink + c.bytes;
+            });
+            rep.add({"parallel_scan", {P("width", w), P("pages", pages),
+                                       {"layout", layout == PageLayout::Pax ? "pax" : "row"},
+                                       P("threads", scan.threads()), P("morsels", scan.morsels())},
+                     rows, s});
+        }
+    }
+}
+
+// SELECT price, COUNT(*), SUM(id), MAX(name) … GROUP BY price (1000 groups)
+// as a ParallelScan: one HashAggregate per thread, merged at the end
+ELVOIDDB_BENCH(group_by)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages)
+    for (PageLayout layout : {PageLayout::Slotted, PageLayout::Pax}) {
+        TableFile tf(freshTable("group"), true, kTypedCols, layout);
+        const uint64_t rows = fillTyped(tf, w, pages);
+        const std::vector<AggSpec> aggs{{AggFn::Count, AggSpec::kStar}, {AggFn::Sum, 0}, {AggFn::Max, 2}};
+
+        for (size_t nt : opt.threads) {
+            ParallelScan scan(tf, nullptr, nt);
+            volatile size_t sink = 0;
+            double s = timeBest(opt.repeat, [&] {
+                std::vector<std::unique_ptr<HashAggregate>> parts;
+                for (size_t i = 0; i < scan.threads(); ++i)
+                    parts.push_back(std::make_unique<HashAggregate>(tf.schema(), std::vector<size_t>{1}, aggs));
+                scan.run([&](size_t worker, size_t, TableScan& morsel) {
+                    RowRef row;
+                    while (morsel.next(row)) parts[worker]->add(row);
+                });
+                for (size_t i = 1; i < parts.size(); ++i) parts[0]->merge(*parts[i]);
+                sink = sink + parts[0]->result().size();
+            });
+            rep.add({"group_by", {P("width", w), P("pages", pages),
+                                  {"layout", layout == PageLayout::Pax ? "pax" : "row"},
+                                  P("threads", scan.threads())},
+                     rows, s});
+        }
+    }
+}
+
+// point lookups WHERE id = k through a B+-tree index, a hash index (both
+// IndexScan) and the full TableScan a table without one needs;
+// ops = lookups
+ELVOIDDB_BENCH(index_lookup)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages)
+    for (PageLayout layout : {PageLayout::Slotted, PageLayout::Pax}) {
+        TableFile tf(freshTable("index"), true, kTypedCols, layout);
+        const uint64_t rows = fillTyped(tf, w, pages);
+        tf.createIndex("by_id", "id");
+        tf.createIndex("by_id_hash", "id", IndexKind::Hash);
+
+        for (const char* path : {"btree", "hash", "scan"}) {
+            const Index* ix = path[0] == 'b' ? tf.indexes()[0].get()
+                            : path[0] == 'h' ? tf.indexes()[1].get() : nullptr;
+            const size_t lookups = ix ? 1000 : 3;
+            volatile size_t sink = 0;
+            double s = timeBest(opt.repeat, [&] {
+                size_t hits = 0;
+                RowRef row;
+                for (size_t l = 0; l < lookups; ++l) {
+                    auto where = Predicate::compare("id", CmpOp::Eq,
+                                                    {Value::Kind::Number, std::to_string(l * 2654435761u % rows)});
+                    where->bind(tf.schema());
+                    if (ix) {
+                        std::vector<Predicate::Term> terms;
+                        KeyRange r;
+                        where->terms(terms);
+                        ix->range(terms, r);
+                        IndexScan scan(tf, *ix, r, where.get());
+                        while (scan.next(row)) ++hits;
+                    } else {
+                        TableScan scan(tf, where.get());
+                        while (scan.next(row)) ++hits;
+                    }
+                }
+                sink = sink + hits;
+            });
+            rep.add({"index_lookup", {P("width", w), P("pages", pages),
+                                      {"layout", layout == PageLayout::Pax ? "pax" : "row"},
+                                      P("height", tf.indexes()[0]->tree().height()),
+                                      P("depth", tf.indexes()[1]->hash().depth()), {"path", path}},
+                     lookups, s});
+        }
+    }
+}
+
+// SELECT … FROM small JOIN big ON small.id = big.id, small = big / 16:
+// the hash join in memory and with every partition spilled (budget 0),
+// and the index nested-loop join through a hash index on big.id;
+// ops = joined rows
+ELVOIDDB_BENCH(join)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        TableFile big(freshTable("join_big"), true, kTypedCols);
+        TableFile small(freshTable("join_small"), true, kTypedCols);
+        fillTyped(big, w, pages);
+        const uint64_t rows = fillTyped(small, w, std::max<size_t>(pages / 16, 1));
+        big.createIndex("by_id", "id", IndexKind::Hash);
+
+        struct Case { const char* name; JoinMethod method; size_t budget; };
+        for (const Case& c : {Case{"hash", JoinMethod::Hash, Join::defaultBudget()},
+                              Case{"hash_spill", JoinMethod::Hash, 0},
+                              Case{"index", JoinMethod::IndexRight, 0}})
+        for (size_t nt : opt.threads) {
+            Join   join({small, 0}, {big, 0}, c.method, c.budget, nt);
+            size_t spilled = 0;
+            volatile size_t sink = 0;
+            double s = timeBest(opt.repeat, [&] {
+                Join once = join;
+                once.run([](const RowRef& a, const RowRef& b, std::string& out) {
+                             a.format(2, out);
+                             b.format(1, out);
+                         },
+                         [&](const std::string& out) { sink = sink + out.size(); });
+                spilled = once.spilled();
+            });
+            rep.add({"join", {P("width", w), P("pages", pages), {"method", c.name},
+                              P("threads", nt), P("spilled", spilled)},
+                     rows, s});
+        }
+    }
+}
+
+// the filter kernels alone: pages × 1024 in-memory values, 1024 per
+// batch, compared and turned into a selection vector
+ELVOIDDB_BENCH(simd_filter)(const Options& opt, Reporter& rep)
+{
+    constexpr size_t kBatch = 1024;
+    for (size_t pages : opt.pages) {
+        const size_t n = pages * kBatch;
+        std::vector<int64_t> ints(n);
+        std::vector<double>  dbls(n);
+        for (size_t i = 0; i < n; ++i) {
+            ints[i] = static_cast<int64_t>((i * 2654435761u) % 1000);
+            dbls[i] = static_cast<double>(ints[i]) + 0.5;
+        }
+        std::vector<uint64_t> mask(simd::maskWords(kBatch));
+        std::vector<uint16_t> sel(kBatch);
+
+        const simd::Isa best = simd::isa();
+        for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Sse42, simd::Isa::Avx2}) {
+            if (!simd::setIsa(isa)) continue;
+            for (const char* type : {"int64", "double"}) {
+                volatile size_t sink = 0;
+                double s = timeBest(opt.repeat, [&] {
+                    size_t hits = 0;
+                    for (size_t b = 0; b < n; b += kBatch) {
+                        if (type[0] == 'i') simd::cmpInt64 (ints.data() + b, kBatch, CmpOp::Lt, 100,   mask.data());
+                        else                simd::cmpDouble(dbls.data() + b, kBatch, CmpOp::Lt, 100.0, mask.data());
+                        hits += simd::toSelection(mask.data(), kBatch, sel.data());
+                    }
+                    sink = sink + hits;
+                });
+                rep.add({"simd_filter", {P("values", n), {"type", type}, {"isa", simd::isaName(isa)}}, n, s});
+            }
+        }
+        simd::setIsa(best);
+    }
+}
+
+// WHERE through TableScan (row at a time on slotted pages, batch kernels
+// then row rebuild on PAX) against VectorScan's bare selection vectors at
+// each ISA the CPU has; output is the matching row count
+ELVOIDDB_BENCH(table_filter_vec)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages)
+    for (PageLayout layout : {PageLayout::Slotted, PageLayout::Pax}) {
+        TableFile tf(freshTable("filter"), true, kTypedCols, layout);
+        const uint64_t rows = fillTyped(tf, w, pages);
+
+        struct Case { const char* name; std::unique_ptr<Predicate> p; };
+        Case cases[] = {
+            {"int_lt",      Predicate::compare("id", CmpOp::Lt, {Value::Kind::Number, std::to_string(rows / 10)})},
+            {"double_ge",   Predicate::compare("price", CmpOp::Ge, {Value::Kind::Number, "900"})},
+            {"text_eq",     Predicate::compare("name", CmpOp::Eq, {Value::Kind::Text, makeRow(w, 7)[1]})},
+            {"text_prefix", Predicate::prefix("name", makeRow(w, 7)[1].substr(0, 4))},
+        };
+        const char* lname = layout == PageLayout::Pax ? "pax" : "row";
+        for (auto& c : cases) {
+            c.p->bind(tf.schema());
+            volatile size_t sink = 0;
+
+            double s = timeBest(opt.repeat, [&] {
+                TableScan scan(tf, c.p.get());
+                RowRef    row;
+                size_t    hits = 0;
+                while (scan.next(row)) ++hits;
+                sink = sink + hits;
+            });
+            rep.add({"table_filter_vec", {P("width", w), P("pages", pages), {"layout", lname},
+                                          {"pred", c.name}, {"eval", "rows"}},
+                     rows, s});
+
+            const simd::Isa best = simd::isa();
+            for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Sse42, simd::Isa::Avx2}) {
+                if (!simd::setIsa(isa)) continue;
+                s = timeBest(opt.repeat, [&] {
+                    VectorScan scan(tf, {}, c.p.get());
+                    size_t     hits = 0;
+                    while (scan.next()) hits += scan.selected();
+                    sink = sink + hits;
+                });
+                rep.add({"table_filter_vec", {P("width", w), P("pages", pages), {"layout", lname},
+                                              {"pred", c.name}, {"eval", simd::isaName(isa)}},
+                         rows, s});
+            }
+            simd::setIsa(best);
+        }
+    }
+}
+
+// SUM(price) over kTypedCols stored row-wise and as PAX, read row by row
+// (TableScan) and as column vectors (ColumnScan)
+ELVOIDDB_BENCH(table_column_sum)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages)
+    for (PageLayout layout : {PageLayout::Slotted, PageLayout::Pax}) {
+        const char* lname = layout == PageLayout::Pax ? "pax" : "row";
+        TableFile tf(freshTable("colsum"), true, kTypedCols, layout);
+        const uint64_t rows = fillTyped(tf, w, pages);
+
+        volatile double sink = 0;
+        double s = timeBest(opt.repeat, [&] {
+            TableScan scan(tf);
+            RowRef    row;
+            double    sum = 0;
+            while (scan.next(row)) if (!row.isNull(1)) sum += row.getDouble(1);
+            sink = sink + sum;
+        });
+        rep.add({"table_column_sum", {P("width", w), P("pages", pages), {"layout", lname},
+                                      {"reader", "rows"}},
+                 rows, s});
+
+        s = timeBest(opt.repeat, [&] {
+            ColumnScan scan(tf, {1});
+            double     sum = 0;
+            while (scan.next()) {
+                const double*  v     = scan.values<double>(0);
+                const uint8_t* nulls = scan.nulls(0);
+                for (uint16_t r = 0; r < scan.rows(); ++r)
+                    if (!(nulls[r >> 3] >> (r & 7) & 1)) sum += v[r];
+            }
+            sink = sink + sum;
+        });
+        rep.add({"table_column_sum", {P("width", w), P("pages", pages), {"layout", lname},
+                                      {"reader", "columns"}},
+                 rows, s});
+    }
+}
+
+// same scan over a read-only (mmap'd) open of the table: no pool copy
+ELVOIDDB_BENCH(table_scan_mmap)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        size_t rows = 0;
+        std::string name = buildTable(w, pages, rows);
+        TableFile tf(name, Access::ReadOnly);
+
+        double s = timeBest(opt.repeat, [&] {
+            std::vector<std::vector<std::string>> dest;
+            tf.loadAllRows(dest);
+        });
+        rep.add({"table_scan_mmap", {P("width", w), P("pages", pages)}, rows, s});
+    }
+}
+
+// same scan, but the kernel page cache is dropped before each repetition so
+// every buffer-pool miss goes to the device
+ELVOIDDB_BENCH(table_scan_cold)(const Options& opt, Reporter& rep)
+{
+    for (size_t w : opt.widths) for (size_t pages : opt.pages) {
+        size_t rows = 0;
+        std::string name = buildTable(w, pages, rows);
+        TableFile tf(name, false);
+
+        const size_t defaultWindow = gBufPool.readAheadWindow();
+        for (size_t ra : {size_t(0), defaultWindow}) {
+            gBufPool.setReadAhead(ra);
+            double s = timeBest(opt.repeat,
+                [&] {
+                    int fd = ::open((name + ".tbl").c_str(), O_RDONLY);
+                    if (fd >= 0) {                       // dirty pages would not drop
+                        ::fdatasync(fd);
+                        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                        ::close(fd);
+                    }
+                    gBufPool.resetStats();
+                },
+                [&] {
+                    std::vector<std::vector<std::string>> dest;
+                    tf.loadAllRows(dest);
+                });
+            rep.add({"table_scan_cold", {P("width", w), P("pages", pages), P("pool", gBufPool.capacity()),
+                                         P("readahead", ra)},
+                     rows, s, {{"prefetched", double(gBufPool.stats().prefetched)}}});
+        }
+        gBufPool.setReadAhead(defaultWindow);
+    }
+}
+
+/* ─── BufferPool ────────────────────────────────────────────── */
+
+ELVOIDDB_BENCH(pool_get_hit)(const Options& opt, Reporter& rep)
+{
+    for (size_t pool : opt.pools) {
+        size_t hot = std::max<size_t>(1, pool / 2);          // always resident
+        FileId file = buildRawFile(hot);
+        BufferPool bp(pool);
+        for (size_t p = 0; p < hot; ++p) bp.fetch(file, p, Latch::Shared);
+
+        const uint64_t ops = 1u << 20;
+        double s = timeBest(opt.repeat, [&] {
+            for (uint64_t i = 0; i < ops; ++i) {
+                bp.fetch(file, i % hot, Latch::Shared);
+            }
+        });
+        rep.add({"pool_get_hit", {P("pool", pool), P("pages", hot)}, ops, s});
+    }
+}
+
+ELVOIDDB_BENCH(pool_get_miss)(const Options& opt, Reporter& rep)
+{
+    for (size_t pool : opt.pools) for (size_t pages : opt.pages) {
+        size_t n = std::max(pages, pool * 2);                // cyclic scan > pool → LRU always misses
+        FileId file = buildRawFile(n);
+        BufferPool bp(pool);
+
+        const uint64_t ops = std::max<uint64_t>(n, 1u << 14);
+        double s = timeBest(opt.repeat, [&] {
+            for (uint64_t i = 0; i < ops; ++i) {
+                bp.fetch(file, i % n, Latch::Shared);
+            }
+        });
+        rep.add({"pool_get_miss", {P("pool", pool), P("pages", n)}, ops, s});
+    }
+}
+
+// sequential pass over a cold raw file (kernel cache dropped): the pure
+// I/O side of a table scan, with and without read-ahead
+ELVOIDDB_BENCH(pool_scan_cold)(const Options& opt, Reporter& rep)
+{
+    for (size_t pool : opt.pools) for (size_t pages : opt.pages) {
+        FileId file = buildRawFile(pages);
+        int fd = gHandles.get(file)->fd();
+        BufferPool bp(pool);
+        const size_t defaultWindow = bp.readAheadWindow();
+
+        for (size_t ra : {size_t(0), defaultWindow}) {
+            bp.setReadAhead(ra);
+            double s = timeBest(opt.repeat,
+                [&] {
+                    for (size_t p = 0; p < pages; ++p) bp.fetch(file, pages - 1 - p, Latch::Shared);
+                    ::fdatasync(fd);                    // evict our own pages from the pool,
+                    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);   // then from the kernel
+                    bp.resetStats();
+                },
+                [&] {
+                    bp.adviseSequential(file, 0);
+                    for (size_t p = 0; p < pages; ++p) bp.fetch(file, p, Latch::Shared);
+                });
+            rep.add({"pool_scan_cold", {P("pool", pool), P("pages", pages), P("readahead", ra),
+                                        {"io", ioBackend().name()}},
+                     pages, s, {{"prefetched", double(bp.stats().prefetched)}}});
+        }
+    }
+}
+
+// update-heavy cyclic pass over pages > pool: how many dirty victims
+// the background writer cleans ahead of eviction, and how well it coalesces
+ELVOIDDB_BENCH(pool_dirty)(const Options& opt, Reporter& rep)
+{
+    for (size_t pool : opt.pools) for (size_t pages : opt.pages) {
+        size_t n = std::max(pages, pool * 4);
+        FileId file = buildRawFile(n);
+        BufferPool bp(pool);
+
+        const uint64_t ops = std::max<uint64_t>(n, 1u << 14);
+        bp.resetStats();
+        double s = timeBest(opt.repeat, [&] {
+            for (uint64_t i = 0; i < ops; ++i) {
+                auto g = bp.fetch(file, i % n, Latch::Exclusive);
+                g.mutPage().raw()[0] ^= 1;
+            }
+        });
+        bp.flushAll();
+        auto st = bp.stats();
+        double total = double(opt.repeat) * double(ops);
+        rep.add({"pool_dirty", {P("pool", pool), P("pages", n), {"io", ioBackend().name()}}, ops, s,
+                 {{"sync_write_ratio", double(st.syncWrites) / total},
+                  {"bg_pages", double(st.bgPages)},
+                  {"pages_per_call", st.bgCalls ? double(st.bgPages) / double(st.bgCalls) : 0.0}}});
+    }
+}
+
+// concurrent fetch/release throughput; pages=hot-set size, so a hot set
+// larger than the pool turns the run miss-heavy
+ELVOIDDB_BENCH(pool_get_mt)(const Options& opt, Reporter& rep)
+{
+    for (size_t pool : opt.pools) for (size_t pages : opt.pages) {
+        FileId file = buildRawFile(pages);
+        BufferPool bp(pool);
+
+        for (size_t nt : opt.threads) {
+            const uint64_t perThread = std::max<uint64_t>((1u << 20) / nt, 1u << 14);
+            double s = timeBest(opt.repeat, [&] {
+                std::vector<std::thread> ts;
+                for (size_t t = 0; t < nt; ++t)
+                    ts.emplace_back([&, t] {
+                        uint64_t x = 0x9E3779B97F4A7C15ull * (t + 1);
+                        for (uint64_t i = 0; i < perThread; ++i) {
+                            x ^= x << 13; x ^= x >> 7; x ^= x << 17;   // xorshift
+                            bp.fetch(file, x % pages, Latch::Shared);
+                        }
+                    });
+                for (auto& th : ts) th.join();
+            });
+            rep.add({"pool_get_mt", {P("pool", pool), P("pages", pages), P("shards", bp.shardCount()),
+                                     P("threads", nt)},
+                     perThread * nt, s});
+        }
+    }
+}
+
+// point lookups on a hot set (half the pool) interrupted by full scans of
+// `pages` cold pages: how much of the hot set survives each policy
+ELVOIDDB_BENCH(pool_policy)(const Options& opt, Reporter& rep)
+{
+    const ReplacementPolicy policies[] = {ReplacementPolicy::Lru, ReplacementPolicy::Clock,
+                                          ReplacementPolicy::LruK, ReplacementPolicy::TwoQ};
+    for (size_t pool : opt.pools) for (size_t pages : opt.pages) {
+        size_t hot = std::max<size_t>(1, pool / 2);
+        FileId file = buildRawFile(hot + pages);
+
+        for (auto pol : policies) {
+            BufferPool bp(pool, pol);
+            const uint64_t rounds = 16, points = 4096;
+            BufferPool::Stats hotStats{0, 0};
+
+            double s = timeBest(opt.repeat, [&] {
+                bp.resetStats();
+                hotStats = {0, 0};
+                uint64_t x = 88172645463325252ull;
+                for (uint64_t r = 0; r < rounds; ++r) {
+                    auto before = bp.stats();
+                    for (uint64_t i = 0; i < points; ++i) {
+                        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                        bp.fetch(file, x % hot, Latch::Shared);
+                    }
+                    auto after = bp.stats();
+                    hotStats.hits   += after.hits - before.hits;
+                    hotStats.misses += after.misses - before.misses;
+                    for (size_t p = 0; p < pages; ++p) bp.fetch(file, hot + p, Latch::Shared);
+                }
+            });
+            auto st = bp.stats();
+            rep.add({"pool_policy",
+                     {{"policy", policyName(pol)}, P("pool", pool), P("hot", hot), P("scan", pages)},
+                     rounds * (points + pages), s,
+                     {{"hit_ratio", double(st.hits) / double(st.hits + st.misses)},
+                      {"hot_hit_ratio", double(hotStats.hits) / double(hotStats.hits + hotStats.misses)}}});
+        }
+    }
+}
+
+/* ─── WAL ───────────────────────────────────────────────────── */
+
+// one row + commit per op, every thread on its own table; under sync=full
+// concurrent commits share fdatasyncs (commits_per_sync > 1)
+ELVOIDDB_BENCH(wal_commit)(const Options& opt, Reporter& rep)
+{
+    for (SyncMode mode : {SyncMode::Off, SyncMode::Normal, SyncMode::Full}) {
+        gWal.open(freshTable("wal") + ".wal", mode);
+        for (size_t nt : opt.threads) {
+            std::vector<std::unique_ptr<TableFile>> tables;
+            for (size_t t = 0; t < nt; ++t)
+                tables.push_back(std::make_unique<TableFile>(freshTable("walt"), true,
+                                                             kCols));
+            const uint64_t perThread = std::max<uint64_t>(4096 / nt, 64);
+            auto before = gWal.stats();
+            double s = timeBest(opt.repeat, [&] {
+                std::vector<std::thread> ts;
+                for (size_t t = 0; t < nt; ++t)
+                    ts.emplace_back([&, t] {
+                        uint64_t seq = t << 32;
+                        for (uint64_t i = 0; i < perThread; ++i) {
+                            tables[t]->appendRow(makeRow(64, seq));
+                            gWal.commit();
+                        }
+                    });
+                for (auto& th : ts) th.join();
+            });
+            auto after = gWal.stats();
+            double syncs = double(after.syncs - before.syncs);
+            rep.add({"wal_commit", {{"sync", syncModeName(mode)}, P("threads", nt)}, perThread * nt, s,
+                     {{"commits_per_sync", syncs ? double(after.commits - before.commits) / syncs : 0.0}}});
+        }
+        gWal.close();
+    }
+}
+
+// util::ThreadPool before work stealing: one std::function queue behind
+// one mutex, kept as the baseline for pool_tasks
+class QueuePool {
+    std::vector<std::thread>          workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex                        mtx_;
+    std::condition_variable           cv_;
+    bool                              shutdown_{false};
+public:
+    explicit QueuePool(size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            workers_.emplace_back([this] {
+                for (;;) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock lock(mtx_);
+                        cv_.wait(lock, [&] { return shutdown_ || !tasks_.empty(); });
+                        if (shutdown_ && tasks_.empty()) return;
+                        task = std::move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                }
+            });
+    }
+    ~QueuePool() {
+        {
+            std::lock_guard lock(mtx_);
+            shutdown_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+    template <typename F>
+    void submit(F&& f) {
+        {
+            std::lock_guard lock(mtx_);
+            tasks_.emplace(std::forward<F>(f));
+        }
+        cv_.notify_one();
+    }
+};
+
+// throughput of tiny tasks (one relaxed increment each) through the old
+// queue pool and the work-stealing pool: post, submit (a future each),
+// a TaskGroup, parallel_for with grain 1, and `spawn` – 64 tasks that
+// each run 1/64 of the work as tasks posted from their worker
+ELVOIDDB_BENCH(pool_tasks)(const Options& opt, Reporter& rep)
+{
+    constexpr size_t kTasks = 1 << 17;
+    for (size_t nt : opt.threads) {
+        QueuePool            queue(nt);
+        util::ThreadPool     pool(nt);
+        std::atomic<size_t>  done{0};
+        auto tick  = [&done] { done.fetch_add(1, std::memory_order_relaxed); };
+        auto drain = [&done] { while (done.load() != kTasks) std::this_thread::yield(); };
+
+        for (const char* mode : {"queue", "post", "submit", "group", "parallel_for", "spawn"}) {
+            const std::string m = mode;
+            double s = timeBest(opt.repeat, [&] {
+                done = 0;
+                if (m == "queue") {
+                    for (size_t i = 0; i < kTasks; ++i) queue.submit(tick);
+                    drain();
+                } else if (m == "post") {
+                    for (size_t i = 0; i < kTasks; ++i) pool.post(tick);
+                    drain();
+                } else if (m == "submit") {
+                    std::vector<std::future<void>> fs;
+                    fs.reserve(kTasks);
+                    for (size_t i = 0; i < kTasks; ++i) fs.push_back(pool.submit(tick));
+                    for (auto& f : fs) f.get();
+                } else if (m == "group") {
+                    util::TaskGroup group(pool);
+                    for (size_t i = 0; i < kTasks; ++i) group.run(tick);
+                    group.wait();
+                } else if (m == "parallel_for") {
+                    pool.parallel_for(0, kTasks, 1, [&](size_t, size_t) { tick(); });
+                } else {
+                    util::TaskGroup outer(pool);
+                    for (size_t r = 0; r < 64; ++r)
+                        outer.run([&] {
+                            util::TaskGroup inner(pool);
+                            for (size_t i = 0; i < kTasks / 64; ++i) inner.run(tick);
+                            inner.wait();
+                        });
+                    outer.wait();
+                }
+            });
+            rep.add({"pool_tasks", {P("threads", nt), {"mode", mode}}, kTasks, s});
+        }
+    }
+}
+
+} // namespace elvoiddb::bench
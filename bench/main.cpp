@@ -0,0 +1,132 @@
+#include "Bench.hpp"
+#include "BufferPool.hpp"
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace elvoiddb::bench {
+
+struct Entry { const char* name; BenchFn fn; };
+
+static std::vector<Entry>& registry()
+{
+    static std::vector<Entry> r;
+    return r;
+}
+
+Registrar::Registrar(const char* name, BenchFn fn) { registry().push_back({name, fn}); }
+
+/* ── output ─────────────────────────────────────────────────── */
+void Reporter::print(const std::string& format) const
+{
+    auto nsPerOp = [](const Result& r) { return r.ops ? r.seconds * 1e9 / r.ops : 0.0; };
+    auto opsPerSec = [](const Result& r) { return r.seconds > 0 ? r.ops / r.seconds : 0.0; };
+
+    if (format == "json") {
+        std::cout << "[\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            std::cout << "  {\"bench\":\"" << r.name << "\",\"params\":{";
+            for (size_t j = 0; j < r.params.size(); ++j)
+                std::cout << (j ? "," : "") << '"' << r.params[j].first << "\":\""
+                          << r.params[j].second << '"';
+            std::cout << "},\"ops\":" << r.ops << ",\"seconds\":" << r.seconds
+                      << ",\"ns_per_op\":" << nsPerOp(r)
+                      << ",\"ops_per_sec\":" << opsPerSec(r);
+            for (const auto& [k, v] : r.metrics) std::cout << ",\"" << k << "\":" << v;
+            std::cout << '}' << (i + 1 == results_.size() ? "\n" : ",\n");
+        }
+        std::cout << "]\n";
+        return;
+    }
+
+    std::cout << "bench,params,ops,seconds,ns_per_op,ops_per_sec,metrics\n";
+    for (const auto& r : results_) {
+        std::cout << r.name << ',';
+        for (size_t j = 0; j < r.params.size(); ++j)
+            std::cout << (j ? ";" : "") << r.params[j].first << '=' << r.params[j].second;
+        std::cout << ',' << r.ops << ',' << r.seconds << ',' << nsPerOp(r) << ','
+                  << opsPerSec(r) << ',';
+        for (size_t j = 0; j < r.metrics.size(); ++j)
+            std::cout << (j ? ";" : "") << r.metrics[j].first << '=' << r.metrics[j].second;
+        std::cout << '\n';
+    }
+}
+
+/* ── helpers ────────────────────────────────────────────────── */
+std::vector<std::string> makeRow(size_t width, uint64_t seq)
+{
+    std::vector<std::string> row(4);
+    std::string id = std::to_string(seq);
+    size_t rest = width > id.size() ? width - id.size() : 0;
+    row[0] = id;
+    for (size_t c = 1; c < 4; ++c)
+        row[c].assign(rest / 3 + (c <= rest % 3 ? 1 : 0), char('a' + (seq + c) % 26));
+    return row;
+}
+
+std::string freshTable(const char* prefix)
+{
+    static size_t counter = 0;
+    return std::string(prefix) + "_" + std::to_string(counter++);
+}
+
+static std::vector<size_t> parseList(const std::string& s)
+{
+    std::vector<size_t> out;
+    std::string tok;
+    std::istringstream ss(s);
+    while (std::getline(ss, tok, ',')) out.push_back(std::stoul(tok));
+    return out;
+}
+
+static void usage()
+{
+    std::cerr << "usage: elvoiddb_bench [--widths=16,64] [--pages=256] [--pools=64]\n"
+                 "                      [--threads=1,2,4] [--repeat=3] [--filter=name] [--format=csv|json]\n";
+}
+
+} // namespace elvoiddb::bench
+
+int main(int argc, char** argv)
+{
+    using namespace elvoiddb::bench;
+    Options opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto eq = a.find('=');
+        std::string key = a.substr(0, eq), val = eq == std::string::npos ? "" : a.substr(eq + 1);
+        try {
+            if      (key == "--widths") opt.widths = parseList(val);
+            else if (key == "--pages")  opt.pages  = parseList(val);
+            else if (key == "--pools")  opt.pools  = parseList(val);
+            else if (key == "--threads") opt.threads = parseList(val);
+            else if (key == "--repeat") opt.repeat = std::stoul(val);
+            else if (key == "--filter") opt.filter = val;
+            else if (key == "--format") opt.format = val;
+            else { usage(); return 1; }
+        } catch (const std::exception&) { usage(); return 1; }
+    }
+
+    // tables are created relative to cwd → run inside a scratch directory
+    fs::path dir = fs::temp_directory_path() / "elvoiddb_bench";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::current_path(dir);
+
+    Reporter rep;
+    for (const auto& e : registry()) {
+        if (!opt.filter.empty() && std::string(e.name).find(opt.filter) == std::string::npos)
+            continue;
+        e.fn(opt, rep);
+    }
+    elvoiddb::storage::gBufPool.flushAll();
+
+    rep.print(opt.format);
+    fs::current_path(fs::temp_directory_path());
+    fs::remove_all(dir);
+    return 0;
+}
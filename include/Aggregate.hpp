@@ -0,0 +1,80 @@
+#pragma once
+#include "Schema.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+enum class AggFn { Count, Sum, Min, Max, Avg };
+
+// one aggregate of a SELECT list: fn(col), or COUNT(*)
+struct AggSpec {
+    static constexpr size_t kStar = SIZE_MAX;
+
+    AggFn  fn;
+    size_t col;             // schema column, or kStar
+};
+
+/* ─── HashAggregate: GROUP BY in an open-addressing table ─────
+   Each row's group columns are packed into a key (per column a null
+   byte, then INT64/DOUBLE as 8 bytes, BOOL as 1, TEXT as a u32 length
+   and the bytes). The key's hash picks a slot, linear probing
+   resolves collisions, and the slot names a group: its key in one
+   arena and one fixed-size state per aggregate in another, so adding
+   a row to a known group allocates nothing.
+
+   A parallel scan gives every worker its own HashAggregate; merge()
+   folds them together at the end. NULLs are skipped by every
+   aggregate but COUNT(*); SUM, MIN, MAX and AVG of no values are
+   NULL, and SUM of INT64 fails on overflow rather than wrapping.
+   Without GROUP BY there is one group, present even for no rows.    */
+class HashAggregate {
+    struct State {
+        union { int64_t i = 0; double d; uint64_t text; };   // text: index into text_
+        uint64_t n{0};                                    // values folded in
+    };
+    struct Slot {
+        uint64_t hash;
+        uint32_t group;     // kEmpty: free
+    };
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    const Schema&            schema_;
+    std::vector<size_t>      keys_;      // GROUP BY columns
+    std::vector<AggSpec>     aggs_;
+    std::vector<Slot>        slots_;     // power-of-two size, at most half full
+    std::string              keyBytes_;  // group keys back to back
+    std::vector<uint32_t>    keyEnd_;    // group → end of its key in keyBytes_
+    std::vector<State>       states_;    // group × aggs_.size()
+    std::vector<std::string> text_;      // MIN/MAX of TEXT and CHAR columns
+    std::string              scratch_;   // the current row's key
+
+    std::string_view key(uint32_t g) const {
+        uint32_t from = g ? keyEnd_[g - 1] : 0;
+        return {keyBytes_.data() + from, keyEnd_[g] - from};
+    }
+    uint32_t group(std::string_view key, uint64_t hash);   // found or added
+    void     grow();
+    void     fold(State& st, const AggSpec& a, const RowRef& row);
+    void     combine(State& st, const State& from, const AggSpec& a, const HashAggregate& src);
+    bool     less(uint32_t a, uint32_t b) const;          // by group values
+    void     formatKey(uint32_t g, std::vector<std::string>& out) const;
+    void     formatAgg(const State& st, const AggSpec& a, std::string& out) const;
+public:
+    // throws ExecutionError for SUM/AVG of a column that is not a number
+    HashAggregate(const Schema& s, std::vector<size_t> groupBy, std::vector<AggSpec> aggs);
+
+    // "COUNT(*)", "SUM(price)", …
+    static std::string label(const AggSpec& a, const Schema& s);
+
+    void   add(const RowRef& row);
+    void   merge(const HashAggregate& other);    // same columns and aggregates
+    size_t groups() const { return keyEnd_.size(); }
+
+    // one row per group, ordered by the group columns: the group values
+    // (in GROUP BY order), then the aggregates, formatted as SELECT prints
+    std::vector<std::vector<std::string>> result() const;
+};
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,102 @@
+#pragma once
+#include "Page.hpp"
+#include "Storage.hpp"
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+/* ─── BTree: disk-resident B+-tree over 4 KB pool pages ────────
+     page 0   meta: magic, root, key width, height, entry count (the
+              magic is first written by build(): a file cut short
+              before that fails to open and is built again)
+     leaf     [NodeHeader][entry …]                 link = right sibling
+     inner    [NodeHeader][entry | child u32 …]     link = leftmost child
+
+   Keys are fixed-width byte strings ordered by memcmp (Index encodes
+   column values so that holds). An entry is the key followed by the
+   rid as 6 big-endian bytes, so entries are unique and sort by a plain
+   memcmp even when keys repeat; the separator in front of a child is
+   the first entry under it. Leaves are chained left to right for range
+   scans.
+
+   Pages go through the buffer pool like table pages. The tree is not
+   logged: an insert stamps the pages it touches with the LSN of the
+   table record it indexes, so the log reaches disk first, and a table
+   the log had to replay gets its indexes rebuilt (TableFile).
+
+   One shared_mutex guards the tree: inserts are exclusive, a Cursor
+   shares it one leaf at a time.                                     */
+class BTree {
+public:
+    static constexpr uint16_t kRidBytes = 6;
+    static constexpr uint16_t kMaxKey   = 64;
+
+    // create: a file for `keyWidth`-byte keys (truncated) that opens
+    // only once build() has run; throws StorageError on a bad file
+    BTree(const fs::path& p, bool create, uint16_t keyWidth = 0);
+
+    uint16_t keyWidth() const { return width_; }
+    uint16_t height()   const { return height_; }
+    uint64_t size()     const { return entries_; }
+
+    // key|rid into out[0 .. keyWidth + kRidBytes), and the rid back
+    static void entry(char* out, const char* key, uint16_t keyWidth, Rid rid);
+    static Rid  ridOf(const char* entry, uint16_t keyWidth);
+
+    // lsn: log record of the row being indexed (0: none)
+    void insert(const char* key, Rid rid, uint64_t lsn = 0);
+    // fill an empty tree from entries sorted by memcmp (maybe none):
+    // leaves are packed and written straight to the file, bypassing the
+    // pool, and synced before the meta page names the root
+    void build(const std::vector<const char*>& sorted);
+
+    // smallest / largest key; false when the tree is empty
+    bool bounds(std::string& lo, std::string& hi) const;
+
+    /* rids of the entries with lo <= key <= hi, in key order. Each leaf is
+       copied out under the tree lock; the next one is found again from
+       the last entry returned, so inserts in between are never skipped. */
+    class Cursor {
+        const BTree*    tree_;
+        std::string     hi_;              // empty: no upper bound
+        std::string     last_;            // entry returned last
+        uint16_t        pos_{0}, count_{0};
+        uint32_t        link_{0};         // right sibling of the copied leaf
+        alignas(8) Page copy_;
+
+        void seek(const std::string& probe, bool after);
+    public:
+        Cursor(const BTree& tree, const std::string& lo, const std::string& hi);
+        bool next(Rid& rid);
+    };
+    // lo / hi: keyWidth bytes, or empty for an open end
+    Cursor scan(const std::string& lo, const std::string& hi) const { return Cursor(*this, lo, hi); }
+
+private:
+    static constexpr uint32_t kMagic = 0x45525442;   // "BTRE"
+
+    BlockFile  bf_;
+    uint16_t   width_{0};
+    uint16_t   height_{0};                // 0: no root yet
+    uint32_t   root_{0};
+    uint64_t   entries_{0};
+    mutable std::shared_mutex mtx_;
+
+    size_t entrySize() const { return size_t(width_) + kRidBytes; }
+    size_t leafCap()   const;
+    size_t innerCap()  const;
+
+    void     writeMeta(uint64_t lsn);
+    uint32_t childFor(const char* node, const char* probe) const;
+    // leaf that holds (or would hold) `probe`; page numbers of the inner
+    // nodes on the way are appended to `path` when given
+    uint32_t descend(const char* probe, std::vector<uint32_t>* path) const;
+    // put (sep, child) into the inner node at path.back(), splitting upward
+    void     insertInner(std::vector<uint32_t>& path, std::string sep, uint32_t child, uint64_t lsn);
+    uint32_t newRoot(uint32_t left, const std::string& sep, uint32_t right, uint64_t lsn);
+};
+
+} // namespace elvoiddb::storage
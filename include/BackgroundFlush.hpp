@@ -0,0 +1,54 @@
+#pragma once
+#include "BufferPool.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+/* ─── BackgroundFlusher: the buffer pool's dedicated writer ────
+   Frames report their clean → dirty transition here. The writer thread
+   wakes every `interval`, or as soon as the dirty list reaches
+   `dirtyRatio` of the pool, and hands the whole list to the pool's
+   write-back routine, which sorts it by (file, page) and writes it in
+   batches through the I/O backend. Keeping the pool mostly clean is
+   what lets eviction skip synchronous writes.                        */
+class BackgroundFlusher {
+public:
+    struct Config {
+        std::chrono::milliseconds interval{100};
+        double                    dirtyRatio{0.25};   // of pool capacity
+        size_t                    maxBatch{64};       // pages per I/O batch
+    };
+
+    using WriteBack = std::function<void(std::vector<PageId>&)>;
+
+    BackgroundFlusher(WriteBack wb, size_t capacity, Config cfg);
+    ~BackgroundFlusher();                             // stops; does not flush
+
+    BackgroundFlusher(const BackgroundFlusher&)            = delete;
+    BackgroundFlusher& operator=(const BackgroundFlusher&) = delete;
+
+    void noteDirty(PageId id);                        // frame just became dirty
+    void kick();                                      // write everything now
+
+    const Config& config() const { return cfg_; }
+
+private:
+    WriteBack               writeBack_;
+    Config                  cfg_;
+    size_t                  highWater_;
+    std::vector<PageId>     dirty_;
+    std::mutex              mtx_;
+    std::condition_variable cv_;
+    bool                    stop_{false};
+    bool                    kicked_{false};
+    std::thread             thread_;
+
+    void run();
+};
+
+} // namespace elvoiddb::storage
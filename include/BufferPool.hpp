@@ -1,58 +1,260 @@
 #pragma once
+#include "FileHandle.hpp"
 #include "Page.hpp"
+#include "Replacer.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <unordered_map>
-#include <list>
-#include <filesystem>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 namespace elvoiddb::storage {
 
-namespace fs = std::filesystem;
-
+/*  (file id, page no) packed into one 64-bit key: copying, hashing and
+    comparing a PageId never allocates                                   */
 struct PageId {
-    fs::path path;   // table file path
-    size_t    no;    // page number
+    uint64_t key{0};   // file id << 32 | page number
+
+    PageId() = default;
+    PageId(FileId file, size_t no) : key(uint64_t(file) << 32 | uint32_t(no)) {}
+
+    FileId file() const { return static_cast<FileId>(key >> 32); }
+    size_t no()   const { return static_cast<uint32_t>(key); }
 
-    bool operator==(const PageId &o) const { return no==o.no && path==o.path; }
+    bool operator==(const PageId &o) const { return key == o.key; }
 };
 
 struct PageIdHash {
     size_t operator()(const PageId &p) const noexcept {
-        return std::hash<std::string>{}(p.path.string()) ^ std::hash<size_t>{}(p.no << 1);
+        uint64_t x = p.key;                  // murmur3 fmix64: every bit mixes
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return static_cast<size_t>(x);
     }
 };
 
-/*  Simple LRU buffer pool (not thread-safe yet)  */
+/*  one cached page; contents are only touched under `latch`  */
+struct Frame {
+    Page                  page;
+    PageId                id;
+    std::atomic<bool>     dirty{false};
+    std::atomic<uint32_t> pin{0};  // 0 → 1 only under the pool mutex
+    std::shared_mutex     latch;   // readers share, writers exclusive
+    bool                  loaded{false};   // contents valid (guarded by latch)
+    bool                  prefetched{false}; // read ahead, not referenced yet (shard mutex)
+    int32_t               ioBuf{-1};       // registered I/O buffer slot, -1 = none
+    std::atomic<uint64_t> lsn{0};          // newest log record applied to the page
+};
+
+enum class Latch { Shared, Exclusive };
+
+class BufferPool;
+class BackgroundFlusher;
+class IoBackend;
+
+/*  RAII handle on a pinned + latched frame. Callers read and mutate the
+    frame in place; the destructor marks it dirty (if written through
+    mutPage) and unpins it.                                             */
+class PageGuard {
+    BufferPool *pool_{nullptr};
+    Frame      *frame_{nullptr};
+    Latch       mode_{Latch::Shared};
+    bool        dirty_{false};
+    bool        ownsPin_{true};    // false when latched through a PagePin
+
+    friend class BufferPool;
+    friend class PagePin;
+    PageGuard(BufferPool *pool, Frame *f, Latch m, bool ownsPin = true)
+        : pool_(pool), frame_(f), mode_(m), ownsPin_(ownsPin) {}
+
+public:
+    PageGuard() = default;
+    PageGuard(PageGuard &&o) noexcept { *this = std::move(o); }
+    PageGuard &operator=(PageGuard &&o) noexcept;
+    PageGuard(const PageGuard &)            = delete;
+    PageGuard &operator=(const PageGuard &) = delete;
+    ~PageGuard() { release(); }
+
+    const Page &page() const { return frame_->page; }
+
+    // exclusive guards only; frame is written back after release
+    Page &mutPage() { dirty_ = true; return frame_->page; }
+
+    // exclusive guards only: the log must reach `lsn` before this page does
+    void setLsn(uint64_t lsn) { frame_->lsn = lsn; }
+
+    size_t pageNo() const { return frame_->id.no(); }
+    explicit operator bool() const { return frame_ != nullptr; }
+
+    // drop latch + pin early (idempotent)
+    void release();
+};
+
+/*  RAII pin without a latch: keeps a frame resident across many short
+    latched accesses (e.g. the tail page of an append-only table).     */
+class PagePin {
+    BufferPool *pool_{nullptr};
+    Frame      *frame_{nullptr};
+
+    friend class BufferPool;
+    PagePin(BufferPool *pool, Frame *f) : pool_(pool), frame_(f) {}
+
+public:
+    PagePin() = default;
+    PagePin(PagePin &&o) noexcept { *this = std::move(o); }
+    PagePin &operator=(PagePin &&o) noexcept;
+    PagePin(const PagePin &)            = delete;
+    PagePin &operator=(const PagePin &) = delete;
+    ~PagePin() { release(); }
+
+    // latch the pinned frame; the guard does not unpin it
+    PageGuard latch(Latch mode) const;
+
+    size_t pageNo() const { return frame_->id.no(); }
+    explicit operator bool() const { return frame_ != nullptr; }
+
+    void release();
+};
+
+/*  Partitioned buffer pool: PageIds hash to one of N shards, each with
+    its own mutex, frame arena, map and replacement policy. Per-frame
+    latches guard page contents; no shard mutex is held across disk I/O. */
 class BufferPool {
-    struct Frame {
-        Page     page;
-        PageId   id;
-        bool     dirty{false};
-        uint32_t pin{0};
+    struct Shard {
+        std::mutex                                     mtx;
+        size_t                                         cap{0};   // max resident frames
+        std::deque<Frame>                              frames;   // stable; index = slot
+        std::vector<uint32_t>                          free;     // unused slots
+        std::unordered_map<PageId, uint32_t, PageIdHash> map;
+        std::unique_ptr<Replacer>                      replacer;
+        uint64_t                                       hits{0}, misses{0};
+        uint64_t                                       syncWrites{0};  // eviction had to write
+        uint64_t                                       prefetched{0};  // pages read ahead
+    };
+
+    // per-file sequential detector (FileIds are dense → plain vector)
+    struct SeqState {
+        size_t last{0};    // last page reported (miss or first prefetched hit)
+        size_t run{0};     // consecutive sequential reports
+        size_t ahead{0};   // read-ahead issued up to here (exclusive)
     };
 
-    size_t max_;                                   // max frames
-    std::list<Frame> lru_;                         // front = most recent
-    std::unordered_map<PageId, std::list<Frame>::iterator, PageIdHash> map_;
-    std::mutex mtx_;
+    size_t                                max_;     // max frames (all shards)
+    ReplacementPolicy                     policy_;
+    std::vector<std::unique_ptr<Shard>>   shards_;
+    IoBackend                            *io_;         // process-wide; outlives the pool
+    std::atomic<void (*)(uint64_t)>       logFlush_{nullptr};
+    std::atomic<uint64_t>                 bgPages_{0}, bgCalls_{0};
+    std::atomic<size_t>                   raWindow_;   // read-ahead pages, 0 = off
+    std::mutex                            raMtx_;
+    std::condition_variable               raIdle_;
+    std::vector<SeqState>                 seq_;        // index = FileId
+    size_t                                raInflight_{0};
+    std::unique_ptr<BackgroundFlusher>    flusher_; // last: stops before shards go
+
+    friend class PageGuard;
+    friend class PagePin;
+
+    // consecutive pages of a file land on consecutive shards, so a hot
+    // range spreads evenly instead of overflowing one small shard
+    Shard &shardFor(const PageId &id) {
+        size_t base = PageIdHash{}(PageId(id.file(), 0));
+        return *shards_[(base + id.no()) % shards_.size()];
+    }
 
     // helper: write page back to disk
     void flushFrame(const Frame &f) const;
 
+    // WAL rule: caller holds a latch on every frame about to be written
+    void logBeforeWrite(uint64_t lsn) const {
+        if (auto fn = logFlush_.load(); fn && lsn) fn(lsn);
+    }
+
+    // make room in a full shard; may drop s.mtx to write a dirty victim.
+    // false → every frame in the shard is pinned
+    bool evictOne(Shard &s, std::unique_lock<std::mutex> &lock);
+
+    // pin; on miss either read the page or (fresh) format it. The frame is
+    // returned exclusively latched when `latched` comes back true.
+    Frame &pin(FileId file, size_t pageNo, bool fresh, bool &latched);
+
+    // claim a free slot for `id`; frame comes back pinned, not loaded
+    Frame &install(Shard &s, PageId id, uint64_t key);
+
+    // read page contents; caller holds the exclusive latch
+    void load(Frame &f);
+
+    // latch a pinned frame, (re)loading it if an earlier read failed
+    PageGuard latchFrame(Frame &f, Latch mode, bool ownsPin);
+
+    void unpin(Frame &f) { f.pin.fetch_sub(1); }
+
+    // clean → dirty transition: queue the page for the background writer
+    void noteDirty(const Frame &f);
+
+    // background writer / flushAll: sort by (file, page) and write the
+    // still-dirty pages in batches through the I/O backend
+    void writeBack(std::vector<PageId> &ids);
+    bool writeBatch(std::vector<Frame *> &batch);   // pinned frames; false → some failed
+
+    // a miss (or first touch of a read-ahead page) at `id`; schedules the
+    // next window on the worker pool once access looks sequential
+    void readAhead(PageId id);
+    // queue prefetch on the worker pool (raInflight_ already counts it)
+    void postPrefetch(FileId file, size_t first, size_t count);
+    void prefetchTask(const std::shared_ptr<FileHandle> &fh, FileId file, size_t first, size_t count);
+    // worker side: claim absent pages without evicting pinned ones, preadv runs
+    void prefetch(FileHandle &fh, FileId file, size_t first, size_t count);
+    Frame *reserve(FileId file, size_t pageNo);
+
 public:
-    explicit BufferPool(size_t m = 64) : max_(m) {}
+    struct Stats {
+        uint64_t hits{0}, misses{0};
+        uint64_t syncWrites{0};            // dirty victims written inside fetch
+        uint64_t bgPages{0}, bgCalls{0};   // write-back: pages / I/O system calls
+        uint64_t prefetched{0};            // pages brought in by read-ahead
+    };
 
-    // fetch page: loads from disk if absent; pins it and returns reference
-    Page &get(const fs::path &file, size_t pageNo);
+    // shards = 0 → pick from the frame count (≈8 frames per shard, ≤ 16)
+    explicit BufferPool(size_t m = 64,
+                        ReplacementPolicy policy = ReplacementPolicy::Lru,
+                        size_t shards = 0);
+    ~BufferPool();
 
-    // mark page as dirty (caller changed it)
-    void markDirty(const fs::path &file, size_t pageNo);
+    // pin + latch page (loads from disk if absent)
+    PageGuard fetch(FileId file, size_t pageNo, Latch mode);
 
-    // unpin when caller done
-    void unpin(const fs::path &file, size_t pageNo);
+    // pin only; latch through PagePin::latch before touching contents
+    PagePin pinPage(FileId file, size_t pageNo);
 
-    // flush & drop all frames (called at shutdown)
+    // pin a page just allocated past EOF: formatted empty, no disk read
+    PagePin pinNew(FileId file, size_t pageNo);
+
+    // scan hint: read `from` onwards ahead of the caller, without waiting
+    // for two sequential misses first
+    void adviseSequential(FileId file, size_t from);
+
+    // read-ahead window in pages (capped at half the pool); 0 disables
+    void   setReadAhead(size_t pages);
+    size_t readAheadWindow() const { return raWindow_; }
+
+    // called with a page's LSN before the page is written (nullptr: no log)
+    void setLogFlush(void (*fn)(uint64_t lsn)) { logFlush_ = fn; }
+
+    // wait for read-ahead, then write every dirty frame back (called at shutdown)
     void flushAll();
+
+    size_t            capacity()   const { return max_; }
+    size_t            shardCount() const { return shards_.size(); }
+    ReplacementPolicy policy()     const { return policy_; }
+
+    // hit / miss counters summed over all shards
+    Stats stats();
+    void  resetStats();
 };
 
 extern BufferPool gBufPool;   // global instance
@@ -1,21 +1,14 @@
 #pragma once
+#include "Aggregate.hpp"
 #include "Exceptions.hpp"
 #include "Storage.hpp"
 #include <memory>
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 namespace elvoiddb {
 
-/* ---------- simple in-memory table ---------- */
-struct MemTable {
-    std::vector<std::string>              columns;
-    std::vector<std::vector<std::string>> rows;
-};
-
-extern std::unordered_map<std::string, MemTable> gMemDB;
-extern storage::FileManager                      gFileMgr;
+extern storage::FileManager gFileMgr;
 
 /* ---------- Command hierarchy ---------- */
 class SQLCommand {
@@ -27,23 +20,72 @@ public:
 class CreateTableCmd : public SQLCommand {
     std::string               name_;
     std::vector<std::string>  cols_;
+    storage::PageLayout       layout_;
 public:
-    CreateTableCmd(std::string n, std::vector<std::string> c);
+    CreateTableCmd(std::string n, std::vector<std::string> c,
+                   storage::PageLayout layout = storage::PageLayout::Slotted);
+    void execute() override;
+};
+
+class CreateIndexCmd : public SQLCommand {
+    std::string name_;
+    std::string table_;
+    std::string column_;
+    storage::IndexKind kind_;
+public:
+    CreateIndexCmd(std::string n, std::string table, std::string column,
+                   storage::IndexKind kind = storage::IndexKind::BTree);
     void execute() override;
 };
 
 class InsertCmd : public SQLCommand {
-    std::string               name_;
-    std::vector<std::string>  values_;
+    std::string                            name_;
+    std::vector<std::vector<std::string>>  rows_;     // one per VALUES tuple
 public:
-    InsertCmd(std::string n, std::vector<std::string> v);
+    InsertCmd(std::string n, std::vector<std::vector<std::string>> rows);
     void execute() override;
 };
 
-class SelectCmd : public SQLCommand {
+class CopyCmd : public SQLCommand {
     std::string name_;
+    std::string path_;
+    char        delim_;
+    bool        header_;     // skip the first record
+public:
+    CopyCmd(std::string n, std::string path, char delim, bool header);
+    void execute() override;
+};
+
+// one SELECT list entry: a column, or fn(column) / COUNT(*)
+struct SelectItem {
+    std::string    column;                     // "*" for COUNT(*)
+    bool           agg{false};
+    storage::AggFn fn{storage::AggFn::Count};
+};
+
+class SelectCmd : public SQLCommand {
+    std::string                          name_;
+    std::unique_ptr<storage::Predicate>  where_;     // nullptr: every row
+    std::vector<SelectItem>              items_;     // empty: *
+    std::vector<std::string>             groupBy_;
+
+    void aggregate(storage::TableFile& tf);
+public:
+    explicit SelectCmd(std::string n, std::unique_ptr<storage::Predicate> where = nullptr,
+                       std::vector<SelectItem> items = {}, std::vector<std::string> groupBy = {});
+    void execute() override;
+};
+
+/* SELECT … FROM a [INNER] JOIN b ON a.x = b.y [WHERE …]: columns are
+   "t.col", or "col" when only one of the tables has it */
+class JoinCmd : public SQLCommand {
+    std::string                          left_, right_;
+    std::string                          leftOn_, rightOn_;   // the ON columns, as written
+    std::unique_ptr<storage::Predicate>  where_;
+    std::vector<SelectItem>              items_;              // empty: *
 public:
-    explicit SelectCmd(std::string n);
+    JoinCmd(std::string left, std::string right, std::string leftOn, std::string rightOn,
+            std::unique_ptr<storage::Predicate> where = nullptr, std::vector<SelectItem> items = {});
     void execute() override;
 };
 
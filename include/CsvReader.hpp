@@ -0,0 +1,46 @@
+#pragma once
+#include "Exceptions.hpp"
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace elvoiddb::util {
+
+namespace fs = std::filesystem;
+
+/* ─── CsvReader: streaming delimited-text scanner ─────────────
+   Reads the file in large chunks and splits records in place: memchr
+   finds the line end and then each delimiter, so unquoted fields are
+   never copied. A record containing '"' takes the slow path, which
+   unescapes quoted fields ("a,b", "say ""hi""", embedded newlines)
+   into a scratch buffer. CR before LF is dropped; blank lines are
+   skipped.                                                          */
+class CsvReader {
+    int               fd_{-1};
+    fs::path          path_;
+    char              delim_;
+    std::vector<char> buf_;
+    size_t            pos_{0}, end_{0};   // unparsed bytes: buf_[pos_, end_)
+    bool              eof_{false};
+    std::string       scratch_;           // unescaped quoted fields
+    size_t            record_{0};
+
+    // compact, then read more (growing the buffer when one record fills it);
+    // false once the file is exhausted
+    bool fill();
+    // quoted record starting at buf_[pos_]; false → it runs past end_
+    bool splitQuoted(std::vector<std::string_view>& fields);
+public:
+    CsvReader(const fs::path& p, char delim);
+    ~CsvReader();
+    CsvReader(const CsvReader&)            = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    // next record; the views stay valid until the following call. false at EOF
+    bool next(std::vector<std::string_view>& fields);
+
+    size_t record() const { return record_; }   // 1-based number of the last record
+};
+
+} // namespace elvoiddb::util
@@ -0,0 +1,82 @@
+#pragma once
+#include "BTree.hpp"
+#include "Page.hpp"
+#include "Storage.hpp"
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+/* ─── ExtendibleHash: on-disk hash index over 4 KB pool pages ──
+     page 0   meta: magic, key width, depth, entry count and the page
+              numbers of the directory pages (magic first written by
+              build(), as for BTree)
+     dir      u32 bucket page per directory slot, 1024 slots a page
+     bucket   [BucketHeader][entry …]     entry = key | rid, unordered
+
+   The directory has 2^depth slots indexed by the low bits of the key's
+   hash. It is kept in memory and written through when it changes, so
+   a probe reads one bucket page. A full bucket splits on its next hash
+   bit, doubling the directory when the bucket already uses all of its
+   bits. When no bit below kMaxDepth tells its entries apart (one key
+   repeated, or a full directory) it grows a chain of overflow pages
+   instead. New overflow pages go right after the chain's head, and
+   every page past the first two is full, so an insert reads at most
+   two bucket pages however long the chain is.
+
+   Keys and rids are encoded as in BTree; durability and locking work
+   the same way (pages carry the indexed row's LSN, one shared_mutex). */
+class ExtendibleHash {
+public:
+    static constexpr uint16_t kMaxDepth = 19;      // 2^19 slots: 512 directory pages
+
+    // create: a file for `keyWidth`-byte keys (truncated) that opens
+    // only once build() has run; throws StorageError on a bad file
+    ExtendibleHash(const fs::path& p, bool create, uint16_t keyWidth = 0);
+
+    uint16_t keyWidth() const { return width_; }
+    uint16_t depth()    const { return depth_; }
+    uint64_t size()     const { return entries_; }
+
+    // lsn: log record of the row being indexed (0: none)
+    void insert(const char* key, Rid rid, uint64_t lsn = 0);
+    // key|rid entries into a built index; the meta page is written once
+    void insert(const std::vector<const char*>& entries, uint64_t lsn = 0);
+    // fill an empty index from key|rid entries in any order: buckets are
+    // sized up front and written straight to the file, then synced
+    void build(const std::vector<const char*>& entries);
+
+    // rids of every entry whose key is exactly `key`, appended to `out`
+    void probe(const char* key, std::vector<Rid>& out) const;
+
+private:
+    static constexpr uint32_t kMagic   = 0x48545845;   // "EXTH"
+    static constexpr size_t   kDirSlots = PAGE_SIZE / sizeof(uint32_t);
+
+    BlockFile             bf_;
+    uint16_t              width_{0};
+    uint16_t              depth_{0};
+    uint64_t              entries_{0};
+    std::vector<uint32_t> dir_;             // slot → bucket page
+    std::vector<uint32_t> dirPages_;        // pages holding dir_
+    mutable std::shared_mutex mtx_;
+
+    size_t entrySize() const { return size_t(width_) + BTree::kRidBytes; }
+    size_t bucketCap() const;
+    uint64_t hashOf(const char* key) const;
+
+    void writeMeta(uint64_t lsn);
+    // directory slots [from, to) back to their pages (allocated as needed)
+    void writeDir(size_t from, size_t to, uint64_t lsn);
+    // split bucket `page` (local depth `local`) on hash bit `local`
+    void split(uint32_t page, uint16_t local, uint64_t lsn);
+    // entry e (hash h) into its bucket, splitting or chaining as needed
+    void add(const char* e, uint64_t h, uint64_t lsn);
+    // can a split ever separate `entry` from the keys on bucket page `page`?
+    // (only the head of a chain is looked at)
+    bool splittable(uint32_t page, const char* entry) const;
+};
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,89 @@
+#pragma once
+#include "Exceptions.hpp"
+#include "Page.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+namespace fs = std::filesystem;
+
+/* ─── FileHandle: one open fd, positional page I/O ─────────────
+   pread/pwrite never touch the shared file offset, so any number of
+   threads may read or write different pages of the same file at once. */
+class FileHandle {
+    int      fd_{-1};
+    fs::path path_;
+public:
+    FileHandle(const fs::path& p, bool create);
+    ~FileHandle();
+    FileHandle(const FileHandle&)            = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    void   readPage (size_t pageNo, char* buf) const;   // short read → zero-fill
+    void   writePage(size_t pageNo, const char* buf);
+    // consecutive pages [first, first + bufs.size()) in one preadv; zero-fill past EOF
+    void   readPages (size_t first, const std::vector<char*>& bufs) const;
+    // consecutive pages [first, first + bufs.size()) in one pwritev
+    void   writePages(size_t first, const std::vector<const char*>& bufs);
+    size_t pageCount() const;                           // fstat, rounded down
+    void   truncate(size_t pages = 0);                  // cut (or zero-extend) to `pages`
+    void   sync();                                      // fdatasync
+
+    int             fd()   const { return fd_; }
+    const fs::path& path() const { return path_; }
+};
+
+/* ─── MappedFile: read-only mmap of a whole file ───────────────
+   Sized once at construction; pages appended afterwards are not
+   visible. Used for read-only tables, whose scans then read records
+   straight out of the page cache with no buffer-pool copy.          */
+class MappedFile {
+    const char* base_{nullptr};
+    size_t      pages_{0};
+public:
+    explicit MappedFile(const FileHandle& fh);
+    ~MappedFile();
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* page(size_t n) const { return base_ + n * PAGE_SIZE; }
+    size_t      pageCount()    const { return pages_; }
+
+    void adviseSequential() const;   // MADV_SEQUENTIAL: aggressive kernel read-ahead
+    void adviseRandom()     const;
+};
+
+/* ─── HandleCache: dense FileId → shared FileHandle ──────────
+   Every table file gets a 32-bit id when first opened; ids are never
+   reused, so a (file id, page no) pair names a page for the lifetime of
+   the process. Shared by BlockFile and BufferPool, so a table is opened
+   once instead of once per page I/O.                                */
+using FileId = uint32_t;
+
+class HandleCache {
+    mutable std::shared_mutex                   mtx_;
+    std::vector<std::shared_ptr<FileHandle>>    byId_;   // index = FileId
+    std::unordered_map<std::string, FileId>     ids_;    // path → FileId
+public:
+    // create=true truncates (or creates) the file; same path → same id
+    FileId open(const fs::path& p, bool create);
+
+    // handle for an open id (throws StorageError if closed)
+    std::shared_ptr<FileHandle> get(FileId id) const;
+
+    void close(FileId id);
+
+    // fdatasync every open file (checkpoints)
+    void syncAll() const;
+};
+
+extern HandleCache gHandles;   // global instance
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,108 @@
+#pragma once
+#include "BTree.hpp"
+#include "ExtendibleHash.hpp"
+#include "Predicate.hpp"
+#include "Schema.hpp"
+#include "Storage.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+// index keys lo <= key <= hi; an empty bound is open
+struct KeyRange {
+    std::string lo, hi;
+};
+
+/* ─── Index: secondary index on one column ────────────────────
+   A BTree or an ExtendibleHash whose keys are the column's values,
+   encoded so that memcmp orders them the way the column compares:
+
+     INT64    8 bytes big-endian, sign bit flipped
+     DOUBLE   8 bytes big-endian, negatives bit-inverted, -0 as 0
+     BOOL     1 byte
+     TEXT     the first 32 bytes, zero padded; CHAR(n) the first
+              min(n, 32) bytes without the padding
+
+   Longer text values share the key of their first bytes, so a key
+   range over text can hold extra rows – IndexScan checks the whole
+   WHERE on every row it fetches. NULLs are not indexed. A hash index
+   answers only `col = literal`, with one bucket read instead of a
+   descent.
+
+   The index lives in "<table>.<index>.idx"; the table's catalog lists
+   it and TableFile keeps it up to date.                             */
+class Index {
+    std::string name_;
+    size_t      col_;
+    ColType     type_;
+    IndexKind   kind_;
+    std::unique_ptr<BTree>          tree_;   // set for IndexKind::BTree
+    std::unique_ptr<ExtendibleHash> hash_;   // set for IndexKind::Hash
+
+    uint16_t width() const { return tree_ ? tree_->keyWidth() : hash_->keyWidth(); }
+public:
+    static constexpr uint16_t kTextKey = 32;
+
+    static fs::path file(const std::string& table, const std::string& name);
+    static uint16_t keyWidth(const Column& c);
+
+    // create: a new, empty index file that build() must fill
+    Index(const std::string& table, std::string name, const Schema& s, size_t col,
+          IndexKind kind, bool create);
+
+    const std::string&    name()   const { return name_; }
+    size_t                column() const { return col_; }
+    IndexKind             kind()   const { return kind_; }
+    const BTree&          tree()   const { return *tree_; }
+    const ExtendibleHash& hash()   const { return *hash_; }
+
+    // the row's key into out[0 .. keyWidth); false when the column is NULL
+    bool key(const RowRef& row, char* out) const;
+    // one row (INSERT); lsn: its log record
+    void insert(const RowRef& row, Rid rid, uint64_t lsn);
+
+    // many rows at once (CREATE INDEX, COPY): entries are collected in
+    // `batch`, then bulk-built into an empty index, or inserted (sorted,
+    // for a tree)
+    void add(std::string& batch, const RowRef& row, Rid rid) const;
+    void insertBatch(const std::string& batch, uint64_t lsn);
+
+    // keys the terms on this column admit; false when none is on it (for
+    // a hash index: no equality)
+    bool   range(const std::vector<Predicate::Term>& terms, KeyRange& r) const;
+    // share of the entries expected in `r` (0 … 1), from the key bounds
+    double estimate(const KeyRange& r) const;
+};
+
+/* ─── IndexScan: the rows of an index key range ───────────────
+   Walks the range in key order (a hash index: the rids of one key) and
+   fetches each rid straight from its heap page (a PAX row is put back
+   together); rows that fail `where` are skipped, as in TableScan.    */
+class IndexScan {
+    TableFile&        tf_;
+    const Index&      index_;
+    const Predicate*  where_;
+    std::optional<BTree::Cursor> cur_;  // BTree
+    std::vector<Rid>  rids_;            // Hash: the probe's result
+    size_t            at_{0};
+    std::string       rec_;
+public:
+    // most of a table scan's cost is reading every page; past this share
+    // of the rows, one page fetch per row costs more
+    static constexpr double kMaxShare = 0.05;
+
+    // the scan for a bound WHERE, or nullptr when no index narrows it
+    // enough and a TableScan is the better plan
+    static std::unique_ptr<IndexScan> plan(TableFile& tf, const Predicate& where);
+
+    IndexScan(TableFile& tf, const Index& index, const KeyRange& r, const Predicate* where = nullptr);
+
+    const Index& index() const { return index_; }
+    // next matching row; its bytes stay valid until the following call
+    bool next(RowRef& row);
+};
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,49 @@
+#pragma once
+#include "FileHandle.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+/*  one page-sized read or write in a batch. `result` is 0 on success or
+    -errno; a read that runs past EOF is zero-filled and still succeeds. */
+struct PageIo {
+    FileHandle *file{nullptr};
+    size_t      pageNo{0};
+    char       *buf{nullptr};
+    int32_t     bufIndex{-1};   // registered buffer slot, -1 = plain memory
+    bool        write{false};
+    int         result{0};
+};
+
+enum class IoBackendKind { Posix, Uring };
+
+/* ─── IoBackend: batched page I/O for read-ahead and write-back ───
+   Foreground misses still pread a single page; the batch paths (the
+   read-ahead worker and the background writer) hand a whole set of
+   pages to the backend, which keeps as many of them in flight as it
+   can. Posix runs the batch inline as preadv/pwritev over adjacent
+   pages — the callers are already off the query thread. Uring puts
+   every page in its own SQE and waits once for the lot.              */
+class IoBackend {
+public:
+    virtual ~IoBackend() = default;
+    virtual const char *name() const = 0;
+
+    // run every op; returns once all have completed. Result: system calls made
+    virtual size_t submit(std::vector<PageIo> &ops) = 0;
+
+    // register a PAGE_SIZE buffer for fixed-buffer I/O; -1 if not supported
+    virtual int32_t registerBuffer(char *) { return -1; }
+    virtual void    unregisterBuffer(int32_t) {}
+};
+
+// falls back to Posix when io_uring is unavailable or disabled
+std::unique_ptr<IoBackend> makeIoBackend(IoBackendKind want);
+
+// process-wide backend, chosen on first use: ELVOIDDB_IO=posix|uring
+// (default uring, when the kernel allows it)
+IoBackend &ioBackend();
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,115 @@
+#pragma once
+#include "FileHandle.hpp"
+#include "Page.hpp"
+#include "ParallelScan.hpp"
+#include "Predicate.hpp"
+#include "Storage.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace elvoiddb::storage {
+
+// one table of a join: its rows that pass `where` (bound to its schema,
+// or nullptr), matched on column `col`
+struct JoinSide {
+    TableFile&       tf;
+    size_t           col;
+    const Predicate* where{nullptr};
+};
+
+// Hash: partitioned hash join. IndexRight: each left row looks its key
+// up in an index of the right table; IndexLeft the other way round.
+enum class JoinMethod { Hash, IndexRight, IndexLeft };
+
+/* ─── SpillFile: a join partition's rows on temporary pages ───
+   Rows are packed into slotted pages and written one full page at a
+   time, straight to the file and not through the buffer pool. The
+   file is unlinked as soon as it is created, so it goes away with
+   the handle, or with the process after a crash.                     */
+class SpillFile {
+    FileHandle fh_;
+    Page       page_;              // being filled
+    size_t     pages_{0};          // written so far
+    bool       open_{false};       // page_ holds rows
+public:
+    static constexpr size_t kReadPages = 16;   // per read, when joining
+
+    explicit SpillFile(const fs::path& p);
+
+    void append(const std::string& rec);
+    // every row, in append order; appending is over after the first call
+    void forEach(const std::function<void(const char* rec, uint16_t len)>& f);
+};
+
+/* ─── Join: SELECT … FROM a JOIN b ON a.x = b.y ───────────────
+   Pairs the rows of two tables whose join columns are equal. A NULL
+   matches nothing. The columns must be of the same type; TEXT and
+   CHAR(n) count as one.
+
+   Hash: the smaller table (in pages) is the build side. A
+   ParallelScan of it hashes each row's key and moves the row into one
+   of kPartitions partitions by the top bits of the hash. Each thread
+   fills private buffers for the morsel it scans, so no lock is taken
+   per row. Each partition then gets its own chained hash table, built
+   on the pool and small enough to stay in cache. A ParallelScan of the
+   other table probes these tables.
+
+   Once the partitions hold more than `budget` bytes, the partition
+   that crosses the limit is written to a SpillFile, and so is every
+   later build row of that partition. Probe rows of a spilled partition
+   go to a second file. Each such pair of files is joined after the
+   probe scan, as in a Grace hash join. A spilled partition is read
+   back whole; it is not partitioned a second time. Its output reaches
+   emit kSpillOutput bytes at a time. A thread whose partition is not
+   next in line holds at most one such chunk and waits for its turn, so
+   the output held back stays bounded.
+
+   Index nested loop: if the inner table has an index on its join
+   column and the outer table has at most kIndexShare of its pages,
+   each outer row looks its key up in the index. Only the matching
+   inner rows are fetched; the inner table is never scanned.
+
+   Rows come out in the order of the probe (outer) table. Rows from
+   spilled partitions come last, one partition after another.          */
+class Join {
+    JoinSide   left_, right_;
+    JoinMethod method_;
+    size_t     budget_;
+    size_t     threads_;
+    size_t     spilled_{0};
+public:
+    static constexpr size_t kRadixBits  = 6;
+    static constexpr size_t kPartitions = size_t(1) << kRadixBits;
+    static constexpr double kIndexShare = 0.05;
+    static constexpr size_t kSpillOutput = size_t(1) << 18;   // bytes per emit, spilled partitions
+
+    using Produce = std::function<void(const RowRef& left, const RowRef& right, std::string& out)>;
+    using Emit    = ParallelScan::Emit;
+
+    // build-side bytes kept in memory: ELVOIDDB_JOIN_MEMORY (in MB) if
+    // set, else 64 MB
+    static size_t defaultBudget();
+    // the cheaper method for these tables
+    static JoinMethod plan(const JoinSide& left, const JoinSide& right);
+
+    // throws ExecutionError when the join columns cannot be compared,
+    // or for an index method without the index; threads = 0: the pool's
+    // size
+    Join(JoinSide left, JoinSide right, JoinMethod method,
+         size_t budget = defaultBudget(), size_t threads = 0);
+
+    JoinMethod method() const { return method_; }
+    // partitions run() joined from disk
+    size_t     spilled() const { return spilled_; }
+
+    // produce formats one joined pair into a morsel's output, which emit
+    // gets in table order (as ParallelScan::runOrdered); call once
+    void run(const Produce& produce, const Emit& emit);
+private:
+    void hashJoin (const Produce& produce, const Emit& emit);
+    void indexJoin(const Produce& produce, const Emit& emit);
+};
+
+} // namespace elvoiddb::storage
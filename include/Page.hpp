@@ -13,6 +13,16 @@ struct PageHeader {
     uint16_t freeOffset;  // start of free space (grows upward)
 };
 
+// where a record lives in a table file: data page + slot (the row of a PAX page)
+struct Rid {
+    uint32_t page{0};
+    uint16_t slot{0};
+};
+
+// largest record a fresh page can hold (length prefix + one slot entry)
+inline constexpr size_t MAX_RECORD_SIZE =
+    PAGE_SIZE - sizeof(PageHeader) - 2 * sizeof(uint16_t);
+
 class Page {
     char data[PAGE_SIZE]{};
 public:
@@ -24,6 +34,15 @@ public:
     // iterate over every record in insertion order
     void forEachRecord(const std::function<void(const char *, uint16_t)> &cb) const;
 
+    // same, over a page image that lives elsewhere (e.g. an mmap'd file)
+    static void forEachRecord(const char *page,
+                              const std::function<void(const char *, uint16_t)> &cb);
+
+    // slot-by-slot access to a page image, for iterators that cannot
+    // take a callback: record `i` starts at the returned pointer
+    static uint16_t    recordCount(const char *page);
+    static const char *record(const char *page, uint16_t i, uint16_t &len);
+
     // expose raw buffer (needed by BlockFile I/O)
     const char *raw() const { return data; }
     char *raw() { return data; }
@@ -0,0 +1,58 @@
+#pragma once
+#include "Predicate.hpp"
+#include "Storage.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace elvoiddb::storage {
+
+/* ─── ParallelScan: morsel-driven TableScan on gThreadPool ────
+   The data pages are cut into morsels of kMorselPages pages. The
+   calling thread and up to threads − 1 pool workers pull morsels from
+   one shared counter until none are left, so a slow morsel (cold
+   pages, many matches) holds up only the thread that drew it. Each
+   morsel is a TableScan of its own pages and filters where the
+   records lie, as a single scan does.
+
+   One pool worker is left free: read-ahead runs there. Pages appended
+   after construction are not visited.                                */
+class ParallelScan {
+    TableFile&       tf_;
+    const Predicate* where_;
+    size_t           pages_;       // data pages end here
+    size_t           threads_;
+public:
+    static constexpr size_t kMorselPages = 64;
+    // runOrdered: morsels per thread that may be done but not yet emitted
+    static constexpr size_t kAhead = 4;
+
+    // worker: 0 … threads() − 1, one thread's for the whole run()
+    using Body    = std::function<void(size_t worker, size_t morsel, TableScan& scan)>;
+    using Produce = std::function<void(size_t worker, TableScan& scan, std::string& out)>;
+    using Emit    = std::function<void(const std::string& out)>;
+
+    // `where` must be bound to tf's schema; threads = 0: the pool's size
+    ParallelScan(TableFile& tf, const Predicate* where = nullptr, size_t threads = 0);
+
+    size_t morsels() const { return pages_ > 1 ? (pages_ - 2) / kMorselPages + 1 : 0; }
+    size_t threads() const { return threads_; }
+
+    // body runs once per morsel, concurrently and in any order; returns
+    // when all are done and rethrows the first exception one threw (the
+    // morsels not yet started are then skipped)
+    void run(const Body& body);
+    // produce's output per morsel is handed to emit in page order, as
+    // soon as every morsel before it is done; emit runs on one thread
+    // at a time, outside any lock. A thread does not start a morsel more
+    // than kAhead × threads() past the first one not yet emitted, so the
+    // output held back stays bounded.
+    void runOrdered(const Produce& produce, const Emit& emit);
+private:
+    // run()'s loop; claim() hands out the next morsel (morsels(): none
+    // left), cancel() makes it stop after an exception
+    void drive(const std::function<size_t()>& claim, const std::function<void()>& cancel,
+               const Body& body);
+};
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,101 @@
+#pragma once
+#include "Page.hpp"
+#include "Schema.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+struct PaxHeader {
+    uint16_t magic;   // PaxLayout::kMagic
+    uint16_t rows;    // rows stored
+    uint16_t cap;     // value cells per column
+    uint16_t heap;    // start of the text heap (grows down from PAGE_SIZE)
+};
+
+/* ─── PaxLayout: column minipages inside one 4 KB page ─────────
+     [PaxHeader][col 0: null bits | cells][col 1: …] … free … [text heap]
+
+   Each column owns `cap` cells back to back (8-byte types 8-aligned),
+   so one column of one page is a plain C array: INT64 → int64_t[],
+   DOUBLE → double[], BOOL → uint8_t[], CHAR(n) → n-byte cells. A TEXT
+   cell is (u16 offset, u16 length) into the heap at the page end. cap
+   is fixed per schema, sized for ~8 bytes per TEXT value; a page is
+   full when it holds cap rows or the heap meets the minipages.
+
+   Rows come in and go out in the Schema row format, so the log, COPY
+   and TableScan stay layout-blind. The first u16 is kMagic, a slot
+   count no slotted page can reach, so a page says what it is.        */
+class PaxLayout {
+    const Schema*         schema_;
+    uint16_t              cap_{0};
+    uint16_t              fixedEnd_{0};   // end of the last minipage
+    std::vector<uint16_t> nulls_;         // null bitmap of column i
+    std::vector<uint16_t> cells_;         // first cell of column i
+    std::vector<uint16_t> width_;         // cell bytes of column i
+
+    bool place(uint16_t cap);             // offsets for `cap`; false if they overflow
+public:
+    static constexpr uint16_t kMagic    = 0xFFFF;
+    static constexpr uint16_t kTextCell = 2 * sizeof(uint16_t);
+
+    explicit PaxLayout(const Schema& s);  // s must outlive the layout
+
+    static bool     isPax   (const char* page) { return header(page).magic == kMagic; }
+    static uint16_t rowCount(const char* page) { return header(page).rows; }
+    static PaxHeader header (const char* page) {
+        PaxHeader h;
+        std::memcpy(&h, page, sizeof h);
+        return h;
+    }
+
+    uint16_t capacity() const { return cap_; }
+    // TEXT bytes an empty page has room for: a row with more never fits
+    size_t   maxText()  const { return PAGE_SIZE - fixedEnd_; }
+    // the TEXT bytes of one record (Schema row format)
+    size_t   textBytes(const char* rec, uint16_t len) const;
+
+    void format(char* page) const;
+    // transpose one record (Schema row format) into the minipages;
+    // returns its row index, or -1 if the page is full
+    int  insert(char* page, const char* rec, uint16_t len) const;
+    // row `r` back in Schema row format, into `out` (reused)
+    void row(const char* page, uint16_t r, std::string& out) const;
+
+    const char*    cells(const char* page, size_t col) const { return page + cells_[col]; }
+    const char*    cell (const char* page, size_t col, uint16_t r) const {
+        return page + cells_[col] + size_t(r) * width_[col];
+    }
+    const uint8_t* nulls(const char* page, size_t col) const {
+        return reinterpret_cast<const uint8_t*>(page + nulls_[col]);
+    }
+    bool isNull(const char* page, size_t col, uint16_t r) const {
+        return nulls(page, col)[r >> 3] >> (r & 7) & 1;
+    }
+    // TEXT value, or CHAR(n) without its padding
+    std::string_view text(const char* page, size_t col, uint16_t r) const;
+};
+
+/* ─── PaxRow: one row of a PAX page, read in place (RowRef's API) ─ */
+class PaxRow {
+    const PaxLayout* pax_;
+    const char*      page_;
+    uint16_t         r_;
+public:
+    PaxRow(const PaxLayout& pax, const char* page, uint16_t r) : pax_(&pax), page_(page), r_(r) {}
+
+    bool isNull(size_t i) const { return pax_->isNull(page_, i, r_); }
+    int64_t getInt(size_t i) const {
+        int64_t v; std::memcpy(&v, pax_->cell(page_, i, r_), sizeof v); return v;
+    }
+    double getDouble(size_t i) const {
+        double v; std::memcpy(&v, pax_->cell(page_, i, r_), sizeof v); return v;
+    }
+    bool getBool(size_t i) const { return *pax_->cell(page_, i, r_) != 0; }
+    std::string_view getText(size_t i) const { return pax_->text(page_, i, r_); }
+};
+
+} // namespace elvoiddb::storage
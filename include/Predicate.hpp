@@ -0,0 +1,146 @@
+#pragma once
+#include "Exceptions.hpp"
+#include "Schema.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+class ColumnScan;
+
+enum class CmpOp : uint8_t { Eq, Ne, Lt, Le, Gt, Ge };
+
+// a WHERE literal as written: 42, 2.5, 'text', TRUE, NULL
+struct Value {
+    enum class Kind : uint8_t { Null, Number, Text, Bool };
+    Kind        kind{Kind::Null};
+    std::string text;         // number spelling / unquoted text
+    bool        b{false};
+};
+
+/* ─── Predicate: WHERE condition over one table's rows ─────────
+   Built by the parser from column names and literals, then bound to a
+   schema: names become column indexes and each literal is converted
+   once to the column's type. matches() then reads fields straight out
+   of the record bytes (RowRef) or a PAX page (PaxRow) – rows that fail
+   are never turned into text.
+
+   A comparison with a NULL field (or a NULL literal) does not match;
+   with only AND / OR that is exactly SQL's "unknown is not true".
+
+   matchBatch() is the vectorized form: the whole ColumnScan page is
+   tested at once into a bitmask, INT64 / DOUBLE comparisons and TEXT
+   = / LIKE 'p%' on PAX pages through the SIMD kernels (Simd.hpp).
+
+   terms() lists the comparisons every matching row must pass (the
+   AND-ed ones at the top), for an index to narrow the scan to.       */
+class Predicate {
+public:
+    enum class Kind : uint8_t { Cmp, Prefix, IsNull, NotNull, And, Or };
+
+    // `col op literal`, the literal in the column's type: i (INT64),
+    // d (DOUBLE), b (BOOL) or text (TEXT / CHAR; the prefix of LIKE)
+    struct Term {
+        size_t           col;
+        CmpOp            op;
+        bool             prefix;
+        int64_t          i;
+        double           d;
+        bool             b;
+        std::string_view text;
+    };
+
+    static std::unique_ptr<Predicate> compare(std::string column, CmpOp op, Value v);
+    static std::unique_ptr<Predicate> prefix (std::string column, std::string p);   // LIKE 'p%'
+    static std::unique_ptr<Predicate> isNull (std::string column, bool negate);
+    static std::unique_ptr<Predicate> both   (std::unique_ptr<Predicate> l, std::unique_ptr<Predicate> r);
+    static std::unique_ptr<Predicate> either (std::unique_ptr<Predicate> l, std::unique_ptr<Predicate> r);
+
+    // unbound only: the AND-ed parts of `p` (just `p` when it is no AND),
+    // appended to `out`
+    static void split(std::unique_ptr<Predicate> p, std::vector<std::unique_ptr<Predicate>>& out);
+    // unbound only: every column name replaced by f(name), e.g. to strip
+    // the "t." of a JOIN's qualified names
+    void rename(const std::function<std::string(const std::string&)>& f);
+
+    // resolve columns and convert literals; throws ExecutionError on an
+    // unknown column or a literal the column type cannot hold
+    void bind(const Schema& s);
+
+    template <typename Row>
+    bool matches(const Row& row) const;
+
+    // bound only: one bit per row of the scan's current page (bit r of
+    // mask[r / 64]); every column used must be among the scanned ones
+    void matchBatch(const ColumnScan& batch, uint64_t* mask) const;
+    // schema columns the predicate reads (bound only), appended to `out`
+    void columns(std::vector<size_t>& out) const;
+    // bound only: conjuncts an index can answer, appended to `out`
+    // (=, <, <=, >, >= and LIKE 'p%'; an INT64 column against a
+    // fraction is rounded to the integers it admits)
+    void terms(std::vector<Term>& out) const;
+
+private:
+    // how a bound comparison reads its field
+    enum class Eval : uint8_t { Never, Int, IntAsDouble, Double, Bool, Text };
+
+    Kind        kind_;
+    CmpOp       op_{CmpOp::Eq};
+    std::string column_;
+    Value       value_;
+    std::unique_ptr<Predicate> lhs_, rhs_;
+
+    size_t  col_{0};
+    Eval    eval_{Eval::Never};
+    bool    textCells_{false};   // TEXT column: PAX cells are {offset, length}
+    int64_t int_{0};
+    double  dbl_{0};
+
+    explicit Predicate(Kind k) : kind_(k) {}
+
+    template <typename T>
+    bool test(const T& a, const T& b) const {
+        switch (op_) {
+        case CmpOp::Eq: return a == b;
+        case CmpOp::Ne: return a != b;
+        case CmpOp::Lt: return a <  b;
+        case CmpOp::Le: return a <= b;
+        case CmpOp::Gt: return a >  b;
+        case CmpOp::Ge: return a >= b;
+        }
+        return false;
+    }
+};
+
+template <typename Row>
+bool Predicate::matches(const Row& row) const
+{
+    switch (kind_) {
+    case Kind::And:     return lhs_->matches(row) && rhs_->matches(row);
+    case Kind::Or:      return lhs_->matches(row) || rhs_->matches(row);
+    case Kind::IsNull:  return row.isNull(col_);
+    case Kind::NotNull: return !row.isNull(col_);
+    case Kind::Cmp:
+    case Kind::Prefix:  break;
+    }
+    if (eval_ == Eval::Never || row.isNull(col_)) return false;
+    if (kind_ == Kind::Prefix) {
+        std::string_view t = row.getText(col_);
+        return t.size() >= value_.text.size() && t.compare(0, value_.text.size(), value_.text) == 0;
+    }
+    switch (eval_) {
+    case Eval::Int:         return test(row.getInt(col_), int_);
+    case Eval::IntAsDouble: return test(static_cast<double>(row.getInt(col_)), dbl_);   // id < 2.5
+    case Eval::Double:      return test(row.getDouble(col_), dbl_);
+    case Eval::Bool:        return test(row.getBool(col_), value_.b);
+    case Eval::Text:        return test(row.getText(col_), std::string_view(value_.text));
+    case Eval::Never:       break;
+    }
+    return false;
+}
+
+} // namespace elvoiddb::storage
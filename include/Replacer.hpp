@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace elvoiddb::storage {
+
+enum class ReplacementPolicy { Lru, Clock, LruK, TwoQ };
+
+ReplacementPolicy parsePolicy(const std::string& name);   // "lru", "clock", "lru-k", "2q"
+const char*       policyName (ReplacementPolicy p);
+
+/* ─── Replacer: victim selection for one buffer-pool shard ──────
+   Frames are identified by their slot index in the shard. `key` is a
+   stable hash of the PageId, used by policies that remember pages after
+   eviction (2Q's ghost queue). All calls happen under the shard mutex. */
+class Replacer {
+public:
+    virtual ~Replacer() = default;
+
+    // frame was hit (loaded=false) or just filled from disk (loaded=true)
+    virtual void recordAccess(size_t frame, uint64_t key, bool loaded) = 0;
+
+    // frame left the pool
+    virtual void remove(size_t frame) = 0;
+
+    // best victim among frames for which ok(frame) holds
+    virtual std::optional<size_t> victim(const std::function<bool(size_t)>& ok) = 0;
+};
+
+std::unique_ptr<Replacer> makeReplacer(ReplacementPolicy p, size_t capacity);
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,123 @@
+#pragma once
+#include "Exceptions.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+enum class ColType : uint8_t { Int64, Double, Bool, Text, Char };
+
+struct Column {
+    std::string name;
+    ColType     type{ColType::Text};
+    uint16_t    width{0};     // CHAR(n): n
+};
+
+// how text values are spelled: SQL literals ('quoted', NULL) or CSV fields
+enum class Literal { Sql, Csv };
+
+// how data pages hold rows: slotted (whole rows) or PAX (column minipages)
+enum class PageLayout { Slotted, Pax };
+
+class RowRef;
+
+/* ─── Schema: typed column list + binary row codec ─────────────
+   Row layout (all fields at offsets fixed by the schema):
+
+     [null bitmap: ⌈n/8⌉ bytes][fixed slots …][variable data …]
+
+   INT64 / DOUBLE take 8 bytes, BOOL 1, CHAR(n) n (space padded). TEXT
+   values are stored back to back in the variable area; a TEXT slot holds
+   the u16 end offset of its bytes, and they start where the previous
+   TEXT column's end (or the variable area) does. A reader goes straight
+   to a field's slot – no parsing.
+
+   Page 0 stores the catalog as "schema:id INT64,name TEXT,…", or as
+   "pax:…" for a table with PAX data pages (rows keep this format in the
+   log and at the API either way). Tables written before typed columns
+   carry "cols:a,b,…" and keep their old all-text rows (u16 count, then
+   u16 length + bytes per field): those load as a legacy schema whose
+   columns are all TEXT.                                              */
+class Schema {
+    std::vector<Column>   cols_;
+    std::vector<uint16_t> offset_;        // fixed slot of each column
+    std::vector<uint16_t> prevText_;      // slot of the TEXT column before, or kNone
+    uint16_t              fixedEnd_{0};   // bitmap + fixed slots
+    bool                  legacy_{false};
+    PageLayout            pageLayout_{PageLayout::Slotted};
+
+    void layout();
+    template <typename Str>
+    void encodeAs(const std::vector<Str>& values, std::string& out, Literal spelling) const;
+public:
+    static constexpr uint16_t kNone = UINT16_MAX;
+
+    Schema() = default;
+
+    // column definitions as written in CREATE TABLE: "name [TYPE]"
+    // (type defaults to TEXT); throws ParseError on an unknown type
+    static Schema fromDefs(const std::vector<std::string>& defs);
+    // page-0 catalog text (its first line); empty schema if there is none
+    static Schema fromCatalog(std::string_view text);
+    std::string   catalog() const;
+
+    size_t        size()              const { return cols_.size(); }
+    const Column& operator[](size_t i) const { return cols_[i]; }
+    bool          legacy()            const { return legacy_; }
+    PageLayout    pageLayout()        const { return pageLayout_; }
+    void          setPageLayout(PageLayout l);   // PAX needs a typed schema
+    uint16_t      fixedSize()         const { return fixedEnd_; }
+    uint16_t      offset(size_t i)    const { return offset_[i]; }
+    uint16_t      prevText(size_t i)  const { return prevText_[i]; }
+    std::vector<std::string> names() const;
+
+    // text values → record bytes in `out` (reused); throws ExecutionError
+    // on a value the column type cannot hold
+    void encode(const std::vector<std::string_view>& values, std::string& out,
+                Literal spelling) const;
+    void encode(const std::vector<std::string>& values, std::string& out,
+                Literal spelling) const;
+
+    // false if `len` bytes cannot be a record of this schema
+    bool valid(const char* rec, uint16_t len) const;
+
+    static const char* typeName(ColType t);
+};
+
+/* ─── RowRef: typed view of one record (no copy) ──────────────── */
+class RowRef {
+    const Schema* schema_{nullptr};
+    const char*   rec_{nullptr};
+    uint16_t      len_{0};
+
+    std::string_view legacyField(size_t i) const;
+public:
+    RowRef() = default;
+    RowRef(const Schema& s, const char* rec, uint16_t len) : schema_(&s), rec_(rec), len_(len) {}
+
+    size_t size() const { return schema_->size(); }
+    // the record's bytes, in the schema's row format (to copy the row)
+    const char* data()   const { return rec_; }
+    uint16_t    length() const { return len_; }
+
+    bool isNull(size_t i) const {
+        return !schema_->legacy() && (uint8_t(rec_[i >> 3]) >> (i & 7) & 1);
+    }
+    int64_t getInt(size_t i) const {
+        int64_t v; std::memcpy(&v, rec_ + schema_->offset(i), sizeof v); return v;
+    }
+    double getDouble(size_t i) const {
+        double v; std::memcpy(&v, rec_ + schema_->offset(i), sizeof v); return v;
+    }
+    bool getBool(size_t i) const { return rec_[schema_->offset(i)] != 0; }
+    // TEXT bytes, or CHAR(n) without its padding
+    std::string_view getText(size_t i) const;
+
+    // any column as text ("NULL" for null), appended to `out`
+    void format(size_t i, std::string& out) const;
+};
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,45 @@
+#pragma once
+#include "Predicate.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace elvoiddb::storage::simd {
+
+/* ─── filter kernels: one column batch → a bit per row ─────────
+   Each kernel compares n values against a constant and writes the
+   result as a bitmask (bit r of mask[r / 64]); bits past n are cleared,
+   so masks of one batch can be AND-ed / OR-ed word by word. The
+   implementation is picked once, from the CPU, on first use:
+
+     avx2   – 4 × int64 / double or 8 text cells per instruction
+     sse42  – 2 × int64 / double per instruction
+     scalar – plain loops (any CPU; also non-x86 builds)
+
+   ELVOIDDB_SIMD=scalar|sse42|avx2 caps the choice (never above what the
+   CPU has).                                                          */
+enum class Isa { Scalar, Sse42, Avx2 };
+
+Isa         isa();
+const char* isaName(Isa i);
+bool        supported(Isa i);
+// switch implementation (benchmarks); false if the CPU lacks it
+bool        setIsa(Isa i);
+
+inline constexpr size_t maskWords(size_t n) { return (n + 63) / 64; }
+
+void cmpInt64 (const int64_t* v, size_t n, CmpOp op, int64_t k, uint64_t* mask);
+void cmpDouble(const double*  v, size_t n, CmpOp op, double  k, uint64_t* mask);
+
+// PAX TEXT cells ({u16 offset, u16 length} into `page`): value == s, or
+// value starts with s when `prefix`. Lengths are screened in SIMD
+// registers, only candidates are compared byte by byte.
+void textCells(const char* cells, const char* page, size_t n, std::string_view s,
+               bool prefix, uint64_t* mask);
+
+// mask &= ~nulls over n rows (nulls: one bit per row, byte-addressed)
+void clearNulls(uint64_t* mask, const uint8_t* nulls, size_t n);
+// rows whose bit is set, ascending; returns how many
+size_t toSelection(const uint64_t* mask, size_t n, uint16_t* sel);
+
+} // namespace elvoiddb::storage::simd
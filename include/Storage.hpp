@@ -1,9 +1,18 @@
 #pragma once
+#include "BufferPool.hpp"
 #include "Exceptions.hpp"
+#include "FileHandle.hpp"
 #include "Page.hpp"
+#include "PaxPage.hpp"
+#include "Predicate.hpp"
+#include "Schema.hpp"
+#include <atomic>
 #include <filesystem>
-#include <fstream>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -11,42 +20,243 @@ namespace elvoiddb::storage {
 
 namespace fs  = std::filesystem;
 
+class Index;
+
+// ReadOnly tables are mmap'd and bypass the buffer pool entirely
+enum class Access { ReadWrite, ReadOnly };
+
+// CREATE INDEX … USING BTREE (ranges, the default) or HASH (equality only)
+enum class IndexKind { BTree, Hash };
+
 /* ─── BlockFile: raw 4 KB pages on disk ────────────────────── */
 class BlockFile {
-    fs::path    path_;
-    mutable std::fstream file_;
+    fs::path                    path_;
+    FileId                      id_;      // buffer-pool key for this file
+    std::shared_ptr<FileHandle> fh_;      // shared with the buffer pool
+    std::atomic<size_t>         pages_;   // includes pages still only in the pool
+    std::unique_ptr<MappedFile> map_;     // set for Access::ReadOnly
 public:
-    BlockFile(const fs::path& p, bool create);
-    void   writePage(size_t pageNo, const Page& pg);
+    BlockFile(const fs::path& p, bool create, Access access = Access::ReadWrite);
+    void   writePage(size_t pageNo, const Page& pg, uint64_t lsn = 0);   // lsn: log record
     void   readPage (size_t pageNo, Page& pg) const;
-    size_t pageCount();
+    size_t pageCount() const { return pages_; }
+    size_t allocatePage();                         // returns the new page number
+
+    // bulk load: consecutive freshly allocated pages written straight to the
+    // file, never through the pool (none of them may be resident)
+    void   writeDirect(size_t first, const std::vector<const char*>& pages);
+    void   truncatePages(size_t n);                // undo writeDirect past page n
+    void   sync() { fh_->sync(); }
+
+    // read-only mapping, or nullptr when pages go through the pool
+    const MappedFile* mapping() const { return map_.get(); }
+
+    const fs::path& path() const { return path_; }
+    FileId          id()   const { return id_; }
 };
 
-/* ─── TableFile: metadata + data pages ─────────────────────── */
+/* ─── TableFile: metadata + data pages ───────────────────────
+   Page 0 holds the catalog: the schema line, then one
+   "index:<name>:<column>" line per B+-tree index and one
+   "hash:<name>:<column>" line per hash index. Every INSERT and
+   COPY updates the indexes under the same log gate as the rows.      */
 class TableFile {
-    BlockFile bf_;
+    std::string name_;
+    BlockFile   bf_;
+    Schema      schema_;        // from the page-0 catalog
+    std::unique_ptr<PaxLayout> pax_;       // set for PAX data pages
+    std::vector<std::unique_ptr<Index>> indexes_;
+    std::mutex  appendMtx_;
+    PagePin     tail_;          // last data page, pinned while the table is open
+    uint32_t    imagedPage_{UINT32_MAX};   // page whose full image is in the log
+    uint64_t    imagedEpoch_{0};           // … as of this checkpoint epoch
+
+    // WAL record(s) for a row just placed in `slot` of the latched page;
+    // returns the LSN the page now carries (0: no log)
+    uint64_t logAppend(PageGuard& g, bool fresh, uint16_t slot, const std::string& rec);
+    std::string readCatalog() const;            // page-0 text
+    Schema readSchema() const;                  // its first line
+    // open the catalog's indexes; rebuilds those the log may have outrun
+    void   openIndexes();
+    void   buildIndex(Index& ix);               // fill a new index from the rows
+    void   formatPage(Page& pg) const;          // empty data page of this layout
+    int    place(Page& pg, const std::string& rec) const;   // slot / row, or -1 if full
+    // throws "row too large" for a record no empty data page can take
+    void   checkSize(const std::string& rec) const;
+    // fill the tail page, then fresh ones: one latch per page, not per row
+    void appendRecords(const std::vector<std::string>& recs);
 public:
+    // create: `cols` are CREATE TABLE definitions, "name [TYPE]"
     TableFile(const std::string& table, bool create,
-              const std::vector<std::string>& cols = {});
+              const std::vector<std::string>& cols = {},
+              PageLayout layout = PageLayout::Slotted);
+    TableFile(const std::string& table, Access access);   // open existing
+    ~TableFile();
+
+    bool readOnly() const { return bf_.mapping() != nullptr; }
+
+    // CREATE INDEX: build an index over `column` and list it in the catalog
+    void createIndex(const std::string& name, const std::string& column,
+                     IndexKind kind = IndexKind::BTree);
+    const std::vector<std::unique_ptr<Index>>& indexes() const { return indexes_; }
 
-    void appendRow  (const std::vector<std::string>& row);          // INSERT
-    void loadAllRows(std::vector<std::vector<std::string>>& dest);  // full table scan
+    // a copy of the record at `rid` (Schema row format); false if there is none
+    bool readRecord(Rid rid, std::string& out) const;
 
-    BlockFile& bf() { return bf_; }
-    std::vector<std::string> columnList() const;      // parse page-0 header
+    // INSERT: values are SQL literals, encoded per the schema
+    void appendRow  (const std::vector<std::string>& row);
+    void appendRows (const std::vector<std::vector<std::string>>& rows);   // multi-row INSERT
 
-private:
-    static std::string              serializeRow  (const std::vector<std::string>& row);
-    static std::vector<std::string> deserializeRow(const char* data, uint16_t len);
+    // COPY: `next` encodes one record per call (false at the end). Pages
+    // are filled outside the pool and written in runs; all or nothing.
+    // Returns the number of rows loaded.
+    size_t bulkAppend(const std::function<bool(std::string& rec)>& next);
+    void loadAllRows(std::vector<std::vector<std::string>>& dest);  // every row as text
+
+    BlockFile&    bf()           { return bf_; }
+    const Schema& schema() const { return schema_; }   // also the API / log record format
+    const PaxLayout* pax() const { return pax_.get(); } // nullptr for slotted pages
+};
+
+/* ─── PageReader: a table's data pages, one at a time ─────────
+   A pool page is copied out under a shared latch, so no latch or pin is
+   held between calls; a read-only table is read in place from its
+   mapping. Pages appended after the first call are not visited; a
+   range reader visits only data pages [first, end).                  */
+class PageReader {
+    const BlockFile&  bf_;
+    const MappedFile* map_;
+    size_t            next_{1};        // page 0 is metadata
+    size_t            end_;
+    alignas(8) Page   copy_;           // PAX minipages stay 8-aligned
+public:
+    explicit PageReader(const BlockFile& bf);
+    PageReader(const BlockFile& bf, size_t first, size_t end);
+    // next page image, valid until the following call; nullptr at the end
+    const char* next();
+    size_t      pageNo() const { return next_ - 1; }   // of the last image returned
+};
+
+/* ─── ColumnScan: a page of chosen columns at a time ──────────
+   next() loads one data page; column k (the k-th of `cols`) is then a
+   run of rows() cells: int64_t / double / uint8_t (BOOL) / n bytes
+   (CHAR(n)), with a null bitmap of one bit per row. On PAX pages these
+   are the minipages themselves, read where they lie; slotted pages are
+   gathered into the same shape first. TEXT has no cells – use text().
+   A scan built without a table reads no pages itself: the caller hands
+   it page images through load().                                    */
+class ColumnScan {
+    const Schema&             schema_;
+    const PaxLayout*          pax_;
+    std::optional<PageReader> pages_;
+    std::vector<size_t> cols_;
+    std::vector<int>    slot_;          // schema column → k, or -1
+    const char*         page_{nullptr};
+    bool                paxPage_{false};
+    uint16_t            rows_{0};
+    // gathered columns of a slotted page
+    std::vector<std::vector<uint64_t>>         cells_;   // 8-aligned
+    std::vector<std::vector<uint8_t>>          nulls_;
+    std::vector<std::vector<std::string_view>> text_;
+
+    void gather();
+public:
+    static constexpr size_t kMaxRows = 4096;   // rows one page can yield
+
+    ColumnScan(TableFile& tf, std::vector<size_t> cols);
+    // pages of a table with this schema and layout (pax may be nullptr)
+    ColumnScan(const Schema& schema, const PaxLayout* pax, std::vector<size_t> cols);
+
+    bool     next();                               // false at the end
+    void     load(const char* page);               // this page instead; may have no rows
+    uint16_t rows() const { return rows_; }
+    int      slot(size_t col) const { return slot_[col]; }   // k of a schema column
+    const Schema& schema() const { return schema_; }
+
+    // PAX page: cells are the minipages of page(); TEXT cells are
+    // {u16 offset, u16 length} into it
+    bool        inPlace() const { return paxPage_; }
+    const char* page()    const { return page_; }
+
+    const char*    cells(size_t k) const;
+    template <typename T>
+    const T*       values(size_t k) const { return reinterpret_cast<const T*>(cells(k)); }
+    const uint8_t* nulls(size_t k) const;
+    bool isNull(size_t k, uint16_t r) const { return nulls(k)[r >> 3] >> (r & 7) & 1; }
+    // TEXT value, or CHAR(n) without its padding
+    std::string_view text(size_t k, uint16_t r) const;
+};
+
+/* ─── TableScan: pull-based row iterator ──────────────────────
+   Walks the data pages of a table one at a time and yields its rows
+   without materializing them: memory use is one page whatever the table
+   size. Rows of a PAX page are put back together one at a time.
+
+   A `where` predicate (bound to the table's schema) is tested on each
+   record where it lies – in the page copy or the PAX minipages – and
+   only matching rows are returned, so the rest are never decoded or
+   rebuilt. A PAX page is filtered whole, as a ColumnScan batch through
+   Predicate::matchBatch; its rows are then read off the selection
+   vector. Slotted pages are tested row at a time.                    */
+class TableScan {
+    const Schema&     schema_;
+    const PaxLayout*  pax_;
+    const Predicate*  where_;
+    PageReader        pages_;
+    const char*       page_{nullptr};  // current page image
+    bool              paxPage_{false};
+    std::string       row_;            // current PAX row, in record format
+    uint16_t          slot_{0}, slots_{0};
+    uint16_t          last_{0};        // slot of the row returned last
+    // PAX tables with a `where` only: the page batch and its selection
+    std::optional<ColumnScan> batch_;
+    std::vector<uint64_t>     mask_;
+    std::vector<uint16_t>     sel_;
+
+    void init();
+public:
+    explicit TableScan(TableFile& tf, const Predicate* where = nullptr);
+    // just data pages [first, end): one morsel of a ParallelScan
+    TableScan(TableFile& tf, const Predicate* where, size_t first, size_t end);
+
+    // next (matching) record's bytes; valid until the following call. false at the end
+    bool next(const char*& rec, uint16_t& len);
+    // next row as a typed view into the current page (same lifetime)
+    bool next(RowRef& row);
+    // where the row returned last lives
+    Rid  rid() const { return {static_cast<uint32_t>(pages_.pageNo()), last_}; }
+};
+
+/* ─── ColumnRow: row r of a ColumnScan page (RowRef's API) ───── */
+class ColumnRow {
+    const ColumnScan* scan_;
+    uint16_t          r_;
+public:
+    ColumnRow(const ColumnScan& s, uint16_t r) : scan_(&s), r_(r) {}
+
+    bool    isNull   (size_t i) const { return scan_->isNull(scan_->slot(i), r_); }
+    int64_t getInt   (size_t i) const { return scan_->values<int64_t>(scan_->slot(i))[r_]; }
+    double  getDouble(size_t i) const { return scan_->values<double>(scan_->slot(i))[r_]; }
+    bool    getBool  (size_t i) const { return scan_->cells(scan_->slot(i))[r_] != 0; }
+    std::string_view getText(size_t i) const { return scan_->text(scan_->slot(i), r_); }
 };
 
 /* ─── FileManager: keeps TableFile objects open ────────────── */
 class FileManager {
     std::unordered_map<std::string,std::unique_ptr<TableFile>> open_;
+    Access access_{Access::ReadWrite};
 public:
+    // ReadOnly: tables open mmap'd and CREATE is refused (set before use)
+    void        setAccess(Access a) { access_ = a; }
+    Access      access() const      { return access_; }
+
     void        createTable(const std::string& name,
-                            const std::vector<std::string>& cols);
+                            const std::vector<std::string>& cols,
+                            PageLayout layout = PageLayout::Slotted);
     TableFile*  openTable  (const std::string& name);
+
+    // release every table (and its pinned tail) before the pool shuts down
+    void        closeAll();
 };
 
 } // namespace elvoiddb::storage
@@ -1,56 +1,209 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
 #include <vector>
 #include <thread>
-#include <queue>
-#include <functional>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <exception>
+#include <type_traits>
 #include <condition_variable>
 #include <atomic>
 
 namespace elvoiddb::util {
 
-class ThreadPool {
-    std::vector<std::thread>              workers_;
-    std::queue<std::function<void()>>     tasks_;
-    std::mutex                            mtx_;
-    std::condition_variable               cv_;
-    std::atomic<bool>                     shutdown_{false};
-
-    void worker() {
-        while (true) {
-            std::function<void()> task;
-            {
-                std::unique_lock lock(mtx_);
-                cv_.wait(lock, [&]{ return shutdown_ || !tasks_.empty(); });
-                if (shutdown_ && tasks_.empty()) return;
-                task = std::move(tasks_.front());
-                tasks_.pop();
-            }
-            task();
-        }
+/* ─── Task: a move-only void() callable ───────────────────────
+   Callables of up to kInline bytes (a lambda with a few captures) are
+   stored in the Task itself, so queueing one does not allocate; larger
+   ones go to the heap.                                               */
+class Task {
+    static constexpr size_t kInline = 48;
+
+    struct Ops {
+        void (*call)(void* self);
+        void (*move)(void* from, void* to);    // move-construct, then destroy `from`
+        void (*destroy)(void* self);
+    };
+    template <typename F>
+    static constexpr bool kFits = sizeof(F) <= kInline && alignof(F) <= alignof(std::max_align_t) &&
+                                  std::is_nothrow_move_constructible_v<F>;
+
+    template <typename F>
+    static const Ops* inlineOps() {
+        static constexpr Ops ops{
+            [](void* s) { (*static_cast<F*>(s))(); },
+            [](void* from, void* to) {
+                ::new (to) F(std::move(*static_cast<F*>(from)));
+                static_cast<F*>(from)->~F();
+            },
+            [](void* s) { static_cast<F*>(s)->~F(); }};
+        return &ops;
     }
+    template <typename F>
+    static const Ops* heapOps() {                // buf_ holds an F*
+        static constexpr Ops ops{
+            [](void* s) { (**static_cast<F**>(s))(); },
+            [](void* from, void* to) { *static_cast<F**>(to) = *static_cast<F**>(from); },
+            [](void* s) { delete *static_cast<F**>(s); }};
+        return &ops;
+    }
+
+    alignas(std::max_align_t) unsigned char buf_[kInline];
+    const Ops*                              ops_{nullptr};
+
 public:
-    explicit ThreadPool(size_t n = std::thread::hardware_concurrency()) {
-        for (size_t i = 0; i < n; ++i) workers_.emplace_back([this]{ worker(); });
+    Task() = default;
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (kFits<Fn>) {
+            ::new (buf_) Fn(std::forward<F>(f));
+            ops_ = inlineOps<Fn>();
+        } else {
+            *reinterpret_cast<Fn**>(buf_) = new Fn(std::forward<F>(f));
+            ops_ = heapOps<Fn>();
+        }
     }
-    ~ThreadPool() {
-        {
-            std::lock_guard lock(mtx_);
-            shutdown_ = true;
+    Task(Task&& o) noexcept { *this = std::move(o); }
+    Task& operator=(Task&& o) noexcept {
+        if (this == &o) return *this;
+        reset();
+        if (o.ops_) {
+            o.ops_->move(o.buf_, buf_);
+            ops_   = o.ops_;
+            o.ops_ = nullptr;
         }
-        cv_.notify_all();
-        for (auto& w : workers_) w.join();
+        return *this;
     }
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { reset(); }
+
+    void reset() {
+        if (ops_) ops_->destroy(buf_);
+        ops_ = nullptr;
+    }
+    explicit operator bool() const { return ops_ != nullptr; }
+    void operator()() { ops_->call(buf_); }
+};
+
+/* ─── ThreadPool: work-stealing workers ───────────────────────
+   Each worker owns a deque. A task posted from a worker goes to the
+   back of that worker's deque, and the worker pops from the back, so
+   it reruns what it just touched. Tasks posted from any other thread
+   are dealt round-robin to the workers. An idle worker steals from the
+   front of the other deques before it sleeps. Each deque has its own
+   mutex, so submitters and workers rarely meet on the same lock.
+
+   post() queues fire-and-forget work. An exception it throws ends the
+   process, as from any thread. submit() returns a future instead.
+   TaskGroup and parallel_for wait for their tasks, and a waiting
+   thread runs queued tasks meanwhile, so nested waits on a worker
+   cannot deadlock the pool.                                          */
+class ThreadPool {
+    struct alignas(64) Queue {                   // one cache line per lock
+        std::mutex          mtx;
+        std::deque<Task>    tasks;
+        std::atomic<size_t> size{0};             // tasks.size(), for thieves to peek
+    };
+    std::vector<std::unique_ptr<Queue>> queues_;   // one per worker
+    std::vector<std::thread>            workers_;
+    std::mutex                          sleepMtx_;
+    std::condition_variable             wake_;
+    std::atomic<ptrdiff_t>              pending_{0};    // queued, not yet taken (< 0: briefly, a
+                                                        // task taken before its push is counted)
+    std::atomic<size_t>                 sleepers_{0};   // waiting on wake_ …
+    std::atomic<size_t>                 woken_{0};      // … and notified, not yet up
+    std::atomic<size_t>                 deal_{0};       // next queue for outside posts
+    std::atomic<bool>                   shutdown_{false};
+
+    void push(Task t);
+    bool pop(size_t self, Task& t);              // self = queues_.size(): not a worker
+    void worker(size_t i);
+public:
+    explicit ThreadPool(size_t n = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    size_t size() const { return workers_.size(); }
+
     template <typename F>
-    void submit(F&& f) {
-        {
-            std::lock_guard lock(mtx_);
-            tasks_.emplace(std::forward<F>(f));
-        }
-        cv_.notify_one();
+    void post(F&& f) { push(Task(std::forward<F>(f))); }
+
+    template <typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        std::promise<R> p;
+        auto fut = p.get_future();
+        post([p = std::move(p), f = std::forward<F>(f)]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) { f(); p.set_value(); }
+                else                             p.set_value(f());
+            } catch (...) {
+                p.set_exception(std::current_exception());
+            }
+        });
+        return fut;
     }
+
+    // run one queued task on the calling thread; false if none was found
+    bool runOne();
+
+    // f(lo, hi) over [begin, end) in chunks of `grain`, the first one on
+    // the calling thread; returns when all are done, rethrowing the first
+    // exception
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F&& f);
 };
 
 /* global worker pool (created once, used everywhere) */
 extern ThreadPool gThreadPool;
 
+/* ─── TaskGroup: tasks to wait for together ───────────────────
+   run() posts to the pool; wait() returns once every task run so far
+   has finished, running queued tasks of the pool while it waits, and
+   rethrows the first exception one of them threw. The destructor
+   waits too but swallows the exception.                              */
+class TaskGroup {
+    ThreadPool&             pool_;
+    std::atomic<size_t>     pending_{0};
+    std::mutex              mtx_;
+    std::condition_variable done_;
+    std::exception_ptr      error_;
+
+    void finish(std::exception_ptr e);
+public:
+    explicit TaskGroup(ThreadPool& pool = gThreadPool) : pool_(pool) {}
+    TaskGroup(const TaskGroup&)            = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    ~TaskGroup();
+
+    template <typename F>
+    void run(F&& f) {
+        pending_.fetch_add(1);
+        pool_.post([this, f = std::forward<F>(f)]() mutable {
+            std::exception_ptr e;
+            try { f(); } catch (...) { e = std::current_exception(); }
+            finish(e);
+        });
+    }
+    void wait();
+};
+
+template <typename F>
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, F&& f)
+{
+    if (end <= begin) return;
+    if (grain == 0) grain = 1;
+    TaskGroup group(*this);
+    for (size_t lo = begin + grain; lo < end; lo += grain)
+        group.run([&f, lo, hi = std::min(lo + grain, end)] { f(lo, hi); });
+    std::exception_ptr first;
+    try { f(begin, std::min(begin + grain, end)); } catch (...) { first = std::current_exception(); }
+    group.wait();
+    if (first) std::rethrow_exception(first);
+}
+
 } // namespace elvoiddb::util
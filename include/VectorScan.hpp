@@ -0,0 +1,40 @@
+#pragma once
+#include "Predicate.hpp"
+#include "Simd.hpp"
+#include "Storage.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+/* ─── VectorScan: filtered column batches ─────────────────────
+   The vectorized counterpart of TableScan. Each batch is one data page
+   as a ColumnScan sees it (a PAX page's minipages in place, or a
+   slotted page gathered into the same arrays). The predicate runs over
+   the whole batch at once (Predicate::matchBatch), and the result is a
+   selection vector: the ascending row numbers that passed. Batches with
+   no survivors are skipped.
+
+   `cols` are the schema columns the caller reads; the predicate's own
+   columns are scanned as well. Reach any of them through
+   batch().slot(col).                                                 */
+class VectorScan {
+    const Predicate*      where_;
+    ColumnScan            scan_;
+    std::vector<uint64_t> mask_;
+    std::vector<uint16_t> sel_;
+    uint16_t              selected_{0};
+
+    static std::vector<size_t> scanned(std::vector<size_t> cols, const Predicate* where);
+public:
+    // `where` must be bound to tf's schema (nullptr: every row)
+    VectorScan(TableFile& tf, std::vector<size_t> cols, const Predicate* where = nullptr);
+
+    bool next();                                       // false at the end
+
+    const ColumnScan& batch()     const { return scan_; }
+    const uint16_t*   selection() const { return sel_.data(); }
+    uint16_t          selected()  const { return selected_; }
+};
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,116 @@
+#pragma once
+#include "Exceptions.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+namespace elvoiddb::storage {
+
+namespace fs = std::filesystem;
+
+/*  off    – commits never wait; the log is written every interval and
+             nothing is fsync'd (a crash may lose recent commits)
+    normal – commit returns once its records are written to the OS; the
+             log is fsync'd before data pages and at checkpoints
+    full   – commit returns once its records are on disk (group commit) */
+enum class SyncMode { Off, Normal, Full };
+
+SyncMode    parseSyncMode(const std::string& name);   // "off" | "normal" | "full"
+const char* syncModeName(SyncMode m);
+
+/* ─── Wal: redo log with group commit ─────────────────────────
+   Physiological records name a page by (table, page no):
+     Format  – page was freshly allocated (empty; slot 1: a PAX page)
+     Image   – full page image, logged the first time a page is touched
+               after a checkpoint, so a torn data write can be repaired
+     Insert  – record bytes went into `slot`
+     Bulk    – begin / end of a COPY that wrote pages [page, …) straight
+               to the table file; a begin without an end is rolled back
+               by truncating the file to `page` pages
+   Replay is idempotent: an Insert is applied only if the page holds
+   exactly `slot` records. Records are always in Schema row format; on
+   a PAX table replay transposes them as TableFile does. A checkpoint writes every dirty page back,
+   fsyncs the tables and truncates the log; records are never needed
+   from before the last one.
+
+   Appenders hold gate() (shared) across "log + apply" so a checkpoint
+   never truncates records whose pages it has not flushed.
+
+   Index pages are not logged; replayed() names the tables the last
+   replay touched, whose indexes are rebuilt when they are opened.    */
+class Wal {
+public:
+    struct Stats { uint64_t records{0}, commits{0}, syncs{0}, checkpoints{0}; };
+
+    Wal() = default;
+    ~Wal();                                          // stops the writer; no checkpoint
+    Wal(const Wal&)            = delete;
+    Wal& operator=(const Wal&) = delete;
+
+    // replay whatever `path` holds, checkpoint, then start logging
+    void open(const fs::path& path, SyncMode mode);
+    // checkpoint and stop (clean shutdown leaves an empty log)
+    void close();
+
+    bool     enabled() const { return fd_ >= 0; }
+    SyncMode mode()    const { return mode_; }
+    uint64_t epoch()   const { return epoch_; }      // bumps at every checkpoint
+    // had records in the log at open (the table changed since its last checkpoint)
+    bool     replayed(const std::string& table) const { return replayed_.count(table) != 0; }
+
+    std::shared_lock<std::shared_mutex> gate() { return std::shared_lock(gate_); }
+
+    uint64_t logFormat(const std::string& table, uint32_t page, bool pax = false);
+    uint64_t logImage (const std::string& table, uint32_t page, const char* image);
+    uint64_t logInsert(const std::string& table, uint32_t page, uint16_t slot,
+                       const std::string& rec);
+    uint64_t logBulk  (const std::string& table, uint32_t firstPage, bool end);
+
+    // wait, as the sync mode requires, for this thread's records
+    void commit();
+    // WAL rule: records up to `lsn` reach disk before a page carrying it
+    void flushTo(uint64_t lsn);
+
+    void checkpoint();
+    void maybeCheckpoint();                          // when the log outgrew its limit
+
+    Stats stats() const;
+
+private:
+    static constexpr size_t kCheckpointBytes = 16u << 20;
+
+    int                     fd_{-1};
+    fs::path                path_;
+    SyncMode                mode_{SyncMode::Normal};
+    std::atomic<uint64_t>   epoch_{0};
+    std::shared_mutex       gate_;
+    std::unordered_set<std::string> replayed_;       // written by replay() only
+
+    mutable std::mutex      mtx_;
+    std::condition_variable work_, done_;
+    std::string             buf_;                    // appended, not yet written
+    uint64_t                fileOff_{0};             // bytes already in the file
+    uint64_t                nextLsn_{1};
+    uint64_t                writtenLsn_{0}, syncedLsn_{0};
+    uint64_t                writeWant_{0}, syncWant_{0};
+    bool                    writing_{false}, stop_{false};
+    Stats                   stats_;
+    std::thread             writer_;
+
+    uint64_t append(uint8_t type, const std::string& table, uint32_t page,
+                    uint16_t slot, const char* data, size_t len);
+    void     run();
+    void     waitFor(uint64_t lsn, bool sync);
+    void     replay();
+    void     stopWriter();
+};
+
+extern Wal gWal;   // global instance (opened by main)
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,370 @@
+#include "Aggregate.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace elvoiddb::storage {
+
+namespace {
+
+uint64_t hashBytes(std::string_view s)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ s.size();
+    size_t   i = 0;
+    for (; i + 8 <= s.size(); i += 8) {
+        uint64_t w;
+        std::memcpy(&w, s.data() + i, sizeof w);
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    uint64_t w = 0;
+    std::memcpy(&w, s.data() + i, s.size() - i);
+    h = (h ^ w) * 0xff51afd7ed558ccdull;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;          // fmix64 tail
+    h ^= h >> 33;
+    return h;
+}
+
+// bytes of one non-NULL key field at p
+size_t fieldSize(ColType t, const char* p)
+{
+    switch (t) {
+    case ColType::Int64:
+    case ColType::Double: return 8;
+    case ColType::Bool:   return 1;
+    case ColType::Text:
+    case ColType::Char:   break;
+    }
+    uint32_t n;
+    std::memcpy(&n, p, sizeof n);
+    return sizeof n + n;
+}
+
+template <typename T>
+T load(const char* p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+template <typename T>
+void appendNumber(std::string& out, T v)
+{
+    char buf[32];
+    auto r = std::to_chars(buf, buf + sizeof buf, v);
+    out.append(buf, r.ptr);
+}
+
+const char* fnName(AggFn f)
+{
+    switch (f) {
+    case AggFn::Count: return "COUNT";
+    case AggFn::Sum:   return "SUM";
+    case AggFn::Min:   return "MIN";
+    case AggFn::Max:   return "MAX";
+    case AggFn::Avg:   break;
+    }
+    return "AVG";
+}
+
+} // namespace
+
+HashAggregate::HashAggregate(const Schema& s, std::vector<size_t> groupBy, std::vector<AggSpec> aggs)
+    : schema_(s), keys_(std::move(groupBy)), aggs_(std::move(aggs)), slots_(64, Slot{0, kEmpty})
+{
+    for (const auto& a : aggs_) {
+        if (a.col == AggSpec::kStar || (a.fn != AggFn::Sum && a.fn != AggFn::Avg)) continue;
+        ColType t = schema_[a.col].type;
+        if (t != ColType::Int64 && t != ColType::Double)
+            throw ExecutionError(label(a, s) + " needs an INT or DOUBLE column");
+    }
+}
+
+std::string HashAggregate::label(const AggSpec& a, const Schema& s)
+{
+    return std::string(fnName(a.fn)) + "(" + (a.col == AggSpec::kStar ? "*" : s[a.col].name) + ")";
+}
+
+/* ─── the table ─────────────────────────────────────────────── */
+
+uint32_t HashAggregate::group(std::string_view k, uint64_t hash)
+{
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Slot& s = slots_[i];
+        if (s.group == kEmpty) {
+            const uint32_t g = static_cast<uint32_t>(groups());
+            keyBytes_.append(k);
+            keyEnd_.push_back(static_cast<uint32_t>(keyBytes_.size()));
+            states_.resize(states_.size() + aggs_.size());
+            s = {hash, g};
+            if (groups() * 2 > slots_.size()) grow();
+            return g;
+        }
+        if (s.hash == hash && key(s.group) == k) return s.group;
+    }
+}
+
+void HashAggregate::grow()
+{
+    std::vector<Slot> old(slots_.size() * 2, Slot{0, kEmpty});
+    old.swap(slots_);
+    const size_t mask = slots_.size() - 1;
+    for (const Slot& s : old) {
+        if (s.group == kEmpty) continue;
+        size_t i = s.hash & mask;
+        while (slots_[i].group != kEmpty) i = (i + 1) & mask;
+        slots_[i] = s;
+    }
+}
+
+void HashAggregate::add(const RowRef& row)
+{
+    scratch_.clear();
+    for (size_t c : keys_) {
+        if (row.isNull(c)) { scratch_ += '\1'; continue; }
+        scratch_ += '\0';
+        switch (schema_[c].type) {
+        case ColType::Int64: {
+            int64_t v = row.getInt(c);
+            scratch_.append(reinterpret_cast<const char*>(&v), sizeof v);
+            break;
+        }
+        case ColType::Double: {
+            double v = row.getDouble(c);
+            if (v == 0) v = 0;                                 // -0 groups with 0
+            if (v != v) v = std::numeric_limits<double>::quiet_NaN();
+            scratch_.append(reinterpret_cast<const char*>(&v), sizeof v);
+            break;
+        }
+        case ColType::Bool:
+            scratch_ += static_cast<char>(row.getBool(c));
+            break;
+        case ColType::Text:
+        case ColType::Char: {
+            std::string_view t = row.getText(c);
+            uint32_t         n = static_cast<uint32_t>(t.size());
+            scratch_.append(reinterpret_cast<const char*>(&n), sizeof n);
+            scratch_.append(t);
+            break;
+        }
+        }
+    }
+    const uint32_t g  = keys_.empty() && groups() ? 0 : group(scratch_, hashBytes(scratch_));
+    State*         st = states_.data() + size_t(g) * aggs_.size();
+    for (size_t a = 0; a < aggs_.size(); ++a) fold(st[a], aggs_[a], row);
+}
+
+void HashAggregate::fold(State& st, const AggSpec& a, const RowRef& row)
+{
+    if (a.col == AggSpec::kStar) { ++st.n; return; }
+    if (row.isNull(a.col)) return;
+    const ColType t   = schema_[a.col].type;
+    const bool    max = a.fn == AggFn::Max;
+    switch (a.fn) {
+    case AggFn::Count:
+        break;
+    case AggFn::Sum:
+    case AggFn::Avg:
+        if (t == ColType::Double) st.d += row.getDouble(a.col);
+        else if (__builtin_add_overflow(st.i, row.getInt(a.col), &st.i))
+            throw ExecutionError(label(a, schema_) + " overflows INT");
+        break;
+    case AggFn::Min:
+    case AggFn::Max:
+        switch (t) {
+        case ColType::Int64:
+        case ColType::Bool: {
+            int64_t v = t == ColType::Bool ? row.getBool(a.col) : row.getInt(a.col);
+            if (!st.n || (max ? v > st.i : v < st.i)) st.i = v;
+            break;
+        }
+        case ColType::Double: {
+            double v = row.getDouble(a.col);
+            if (!st.n || (max ? v > st.d : v < st.d)) st.d = v;
+            break;
+        }
+        case ColType::Text:
+        case ColType::Char: {
+            std::string_view v = row.getText(a.col);
+            if (!st.n) {
+                st.text = text_.size();
+                text_.emplace_back(v);
+            } else if (max ? v > text_[st.text] : v < text_[st.text]) {
+                text_[st.text].assign(v);
+            }
+            break;
+        }
+        }
+        break;
+    }
+    ++st.n;
+}
+
+/* ─── merging partial aggregates ────────────────────────────── */
+
+void HashAggregate::merge(const HashAggregate& other)
+{
+    for (uint32_t og = 0; og < other.groups(); ++og) {
+        std::string_view k  = other.key(og);
+        const uint32_t   g  = group(k, hashBytes(k));
+        State*           st = states_.data() + size_t(g) * aggs_.size();
+        const State*     from = other.states_.data() + size_t(og) * aggs_.size();
+        for (size_t a = 0; a < aggs_.size(); ++a) combine(st[a], from[a], aggs_[a], other);
+    }
+}
+
+void HashAggregate::combine(State& st, const State& from, const AggSpec& a, const HashAggregate& src)
+{
+    if (!from.n) return;
+    if (a.col == AggSpec::kStar || a.fn == AggFn::Count) { st.n += from.n; return; }
+    const ColType t   = schema_[a.col].type;
+    const bool    max = a.fn == AggFn::Max;
+    switch (a.fn) {
+    case AggFn::Count:
+        break;
+    case AggFn::Sum:
+    case AggFn::Avg:
+        if (t == ColType::Double) st.d += from.d;
+        else if (__builtin_add_overflow(st.i, from.i, &st.i))
+            throw ExecutionError(label(a, schema_) + " overflows INT");
+        break;
+    case AggFn::Min:
+    case AggFn::Max:
+        if (t == ColType::Text || t == ColType::Char) {
+            const std::string& v = src.text_[from.text];
+            if (!st.n) {
+                st.text = text_.size();
+                text_.push_back(v);
+            } else if (max ? v > text_[st.text] : v < text_[st.text]) {
+                text_[st.text] = v;
+            }
+        } else if (t == ColType::Double) {
+            if (!st.n || (max ? from.d > st.d : from.d < st.d)) st.d = from.d;
+        } else {
+            if (!st.n || (max ? from.i > st.i : from.i < st.i)) st.i = from.i;
+        }
+        break;
+    }
+    st.n += from.n;
+}
+
+/* ─── the result ────────────────────────────────────────────── */
+
+bool HashAggregate::less(uint32_t a, uint32_t b) const
+{
+    const char* p = key(a).data();
+    const char* q = key(b).data();
+    for (size_t c : keys_) {
+        const bool pn = *p++, qn = *q++;
+        if (pn || qn) {                                // NULLs first
+            if (pn != qn) return pn;
+            continue;
+        }
+        const ColType t = schema_[c].type;
+        const size_t  ps = fieldSize(t, p), qs = fieldSize(t, q);
+        int cmp = 0;
+        switch (t) {
+        case ColType::Int64: {
+            int64_t x = load<int64_t>(p), y = load<int64_t>(q);
+            cmp = x < y ? -1 : x > y;
+            break;
+        }
+        case ColType::Double: {
+            // NaN (one group, see add()) sorts after every number: < alone
+            // would call it equal to all of them and break the sort
+            double x = load<double>(p), y = load<double>(q);
+            const bool xn = std::isnan(x), yn = std::isnan(y);
+            cmp = xn || yn ? int(xn) - int(yn) : x < y ? -1 : x > y;
+            break;
+        }
+        case ColType::Bool:
+            cmp = *p - *q;
+            break;
+        case ColType::Text:
+        case ColType::Char:
+            cmp = std::string_view(p + 4, ps - 4).compare(std::string_view(q + 4, qs - 4));
+            break;
+        }
+        if (cmp) return cmp < 0;
+        p += ps;
+        q += qs;
+    }
+    return false;
+}
+
+void HashAggregate::formatKey(uint32_t g, std::vector<std::string>& out) const
+{
+    const char* p = key(g).data();
+    for (size_t c : keys_) {
+        std::string& f = out.emplace_back();
+        if (*p++) { f = "NULL"; continue; }
+        const ColType t = schema_[c].type;
+        switch (t) {
+        case ColType::Int64:  appendNumber(f, load<int64_t>(p)); break;
+        case ColType::Double: appendNumber(f, load<double>(p));  break;
+        case ColType::Bool:   f = *p ? "true" : "false";         break;
+        case ColType::Text:
+        case ColType::Char:   f.assign(p + 4, fieldSize(t, p) - 4); break;
+        }
+        p += fieldSize(t, p);
+    }
+}
+
+void HashAggregate::formatAgg(const State& st, const AggSpec& a, std::string& out) const
+{
+    if (a.col == AggSpec::kStar || a.fn == AggFn::Count) { appendNumber(out, st.n); return; }
+    if (!st.n) { out += "NULL"; return; }
+    const ColType t = schema_[a.col].type;
+    switch (a.fn) {
+    case AggFn::Count:
+        break;
+    case AggFn::Sum:
+        if (t == ColType::Double) appendNumber(out, st.d);
+        else                      appendNumber(out, st.i);
+        break;
+    case AggFn::Avg:
+        appendNumber(out, (t == ColType::Double ? st.d : static_cast<double>(st.i)) / static_cast<double>(st.n));
+        break;
+    case AggFn::Min:
+    case AggFn::Max:
+        switch (t) {
+        case ColType::Int64:  appendNumber(out, st.i);            break;
+        case ColType::Double: appendNumber(out, st.d);            break;
+        case ColType::Bool:   out += st.i ? "true" : "false";     break;
+        case ColType::Text:
+        case ColType::Char:   out += text_[st.text];              break;
+        }
+        break;
+    }
+}
+
+std::vector<std::vector<std::string>> HashAggregate::result() const
+{
+    std::vector<std::vector<std::string>> rows;
+    if (keys_.empty() && groups() == 0) {              // no rows: COUNT 0, the rest NULL
+        const State none{};
+        auto& row = rows.emplace_back();
+        for (const auto& a : aggs_) formatAgg(none, a, row.emplace_back());
+        return rows;
+    }
+    std::vector<uint32_t> order(groups());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return less(a, b); });
+
+    rows.reserve(order.size());
+    for (uint32_t g : order) {
+        auto& row = rows.emplace_back();
+        formatKey(g, row);
+        const State* st = states_.data() + size_t(g) * aggs_.size();
+        for (size_t a = 0; a < aggs_.size(); ++a) formatAgg(st[a], aggs_[a], row.emplace_back());
+    }
+    return rows;
+}
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,391 @@
+#include "BTree.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace elvoiddb::storage {
+
+namespace {
+
+struct NodeHeader {
+    uint16_t leaf;     // 1: leaf, 0: inner node
+    uint16_t count;    // entries (separators of an inner node)
+    uint32_t link;     // leaf: right sibling (0 = none); inner: leftmost child
+};
+
+struct Meta {
+    uint32_t magic;
+    uint32_t root;     // 0: empty tree
+    uint16_t keyWidth;
+    uint16_t height;   // levels, leaves included
+    uint32_t pad;
+    uint64_t entries;
+};
+
+constexpr size_t kNode = sizeof(NodeHeader);
+
+NodeHeader header(const char* node)
+{
+    NodeHeader h;
+    std::memcpy(&h, node, sizeof h);
+    return h;
+}
+
+void setHeader(char* node, uint16_t leaf, size_t count, uint32_t link)
+{
+    NodeHeader h{leaf, static_cast<uint16_t>(count), link};
+    std::memcpy(node, &h, sizeof h);
+}
+
+uint32_t childAt(const char* p)
+{
+    uint32_t c;
+    std::memcpy(&c, p, sizeof c);
+    return c;
+}
+
+// first of n items (`stride` bytes apart) whose first `len` bytes are
+// >= probe, or > probe when `after`
+size_t search(const char* node, size_t n, size_t stride, const char* probe, size_t len, bool after)
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int    c   = std::memcmp(node + kNode + mid * stride, probe, len);
+        if (c < 0 || (after && c == 0)) lo = mid + 1;
+        else                            hi = mid;
+    }
+    return lo;
+}
+
+// `item` spliced in at `pos` of a full node's n items
+std::string withItem(const char* node, size_t n, size_t stride, size_t pos, const std::string& item)
+{
+    std::string all;
+    all.reserve((n + 1) * stride);
+    all.append(node + kNode, pos * stride);
+    all += item;
+    all.append(node + kNode + pos * stride, (n - pos) * stride);
+    return all;
+}
+
+} // namespace
+
+BTree::BTree(const fs::path& p, bool create, uint16_t keyWidth)
+    : bf_(p, create)
+{
+    if (create) {
+        if (keyWidth == 0 || keyWidth > kMaxKey) throw StorageError("bad key width for " + p.string());
+        width_ = keyWidth;                             // page 0 has no magic until build()
+        return;
+    }
+    Meta m;
+    {
+        auto g = gBufPool.fetch(bf_.id(), 0, Latch::Shared);
+        std::memcpy(&m, g.page().raw(), sizeof m);
+    }
+    if (m.magic != kMagic || m.keyWidth == 0 || m.keyWidth > kMaxKey || m.root >= bf_.pageCount())
+        throw StorageError("corrupt index " + p.string());
+    width_   = m.keyWidth;
+    height_  = m.height;
+    root_    = m.root;
+    entries_ = m.entries;
+}
+
+size_t BTree::leafCap()  const { return (PAGE_SIZE - kNode) / entrySize(); }
+size_t BTree::innerCap() const { return (PAGE_SIZE - kNode) / (entrySize() + sizeof(uint32_t)); }
+
+void BTree::entry(char* out, const char* key, uint16_t keyWidth, Rid rid)
+{
+    std::memcpy(out, key, keyWidth);
+    unsigned char* r = reinterpret_cast<unsigned char*>(out + keyWidth);
+    r[0] = static_cast<unsigned char>(rid.page >> 24);
+    r[1] = static_cast<unsigned char>(rid.page >> 16);
+    r[2] = static_cast<unsigned char>(rid.page >> 8);
+    r[3] = static_cast<unsigned char>(rid.page);
+    r[4] = static_cast<unsigned char>(rid.slot >> 8);
+    r[5] = static_cast<unsigned char>(rid.slot);
+}
+
+Rid BTree::ridOf(const char* entry, uint16_t keyWidth)
+{
+    const unsigned char* r = reinterpret_cast<const unsigned char*>(entry + keyWidth);
+    return {uint32_t(r[0]) << 24 | uint32_t(r[1]) << 16 | uint32_t(r[2]) << 8 | r[3],
+            static_cast<uint16_t>(r[4] << 8 | r[5])};
+}
+
+void BTree::writeMeta(uint64_t lsn)
+{
+    Meta m{kMagic, root_, width_, height_, 0, entries_};
+    auto g = gBufPool.fetch(bf_.id(), 0, Latch::Exclusive);
+    std::memcpy(g.mutPage().raw(), &m, sizeof m);
+    if (lsn) g.setLsn(lsn);
+}
+
+uint32_t BTree::childFor(const char* node, const char* probe) const
+{
+    const size_t stride = entrySize() + sizeof(uint32_t);
+    NodeHeader   h      = header(node);
+    size_t       i      = search(node, h.count, stride, probe, entrySize(), true);   // separators <= probe
+    return i == 0 ? h.link : childAt(node + kNode + (i - 1) * stride + entrySize());
+}
+
+uint32_t BTree::descend(const char* probe, std::vector<uint32_t>* path) const
+{
+    uint32_t n = root_;
+    for (uint16_t level = height_; level > 1; --level) {
+        auto g = gBufPool.fetch(bf_.id(), n, Latch::Shared);
+        if (path) path->push_back(n);
+        n = childFor(g.page().raw(), probe);
+    }
+    return n;
+}
+
+void BTree::insert(const char* key, Rid rid, uint64_t lsn)
+{
+    std::unique_lock lock(mtx_);
+    const size_t E = entrySize();
+    std::string  e(E, '\0');
+    entry(e.data(), key, width_, rid);
+
+    if (height_ == 0) {                                // first entry: an empty root leaf
+        root_ = static_cast<uint32_t>(bf_.allocatePage());
+        PagePin pin = gBufPool.pinNew(bf_.id(), root_);
+        auto g = pin.latch(Latch::Exclusive);
+        std::memset(g.mutPage().raw(), 0, PAGE_SIZE);
+        setHeader(g.mutPage().raw(), 1, 0, 0);
+        height_ = 1;
+    }
+
+    std::vector<uint32_t> path;
+    uint32_t    leaf  = descend(e.data(), &path);
+    uint32_t    right = 0;
+    std::string sep;
+    {
+        auto       g    = gBufPool.fetch(bf_.id(), leaf, Latch::Exclusive);
+        char*      node = g.mutPage().raw();
+        NodeHeader h    = header(node);
+        size_t     pos  = search(node, h.count, E, e.data(), E, false);
+        if (lsn) g.setLsn(lsn);
+
+        if (h.count < leafCap()) {
+            char* at = node + kNode + pos * E;
+            std::memmove(at + E, at, (h.count - pos) * E);
+            std::memcpy(at, e.data(), E);
+            setHeader(node, 1, h.count + 1, h.link);
+        } else {                                       // split: upper half to a new right sibling
+            std::string all  = withItem(node, h.count, E, pos, e);
+            size_t      n    = h.count + 1u, keep = n / 2;
+            right = static_cast<uint32_t>(bf_.allocatePage());
+            PagePin pin = gBufPool.pinNew(bf_.id(), right);
+            auto    rg  = pin.latch(Latch::Exclusive);
+            char*   rn  = rg.mutPage().raw();
+            std::memset(rn, 0, PAGE_SIZE);
+            setHeader(rn, 1, n - keep, h.link);
+            std::memcpy(rn + kNode, all.data() + keep * E, (n - keep) * E);
+            if (lsn) rg.setLsn(lsn);
+
+            std::memcpy(node + kNode, all.data(), keep * E);
+            setHeader(node, 1, keep, right);
+            sep.assign(all, keep * E, E);
+        }
+    }
+    ++entries_;
+    if (right) insertInner(path, std::move(sep), right, lsn);
+    writeMeta(lsn);
+}
+
+void BTree::insertInner(std::vector<uint32_t>& path, std::string sep, uint32_t child, uint64_t lsn)
+{
+    const size_t E = entrySize(), S = E + sizeof(uint32_t);
+    while (!path.empty()) {
+        uint32_t n = path.back();
+        path.pop_back();
+
+        std::string item = sep;
+        item.append(reinterpret_cast<const char*>(&child), sizeof child);
+
+        auto       g    = gBufPool.fetch(bf_.id(), n, Latch::Exclusive);
+        char*      node = g.mutPage().raw();
+        NodeHeader h    = header(node);
+        size_t     pos  = search(node, h.count, S, sep.data(), E, true);
+        if (lsn) g.setLsn(lsn);
+
+        if (h.count < innerCap()) {
+            char* at = node + kNode + pos * S;
+            std::memmove(at + S, at, (h.count - pos) * S);
+            std::memcpy(at, item.data(), S);
+            setHeader(node, 0, h.count + 1, h.link);
+            return;
+        }
+        // split: the middle separator moves up, its child becomes the
+        // leftmost of the new right node
+        std::string all = withItem(node, h.count, S, pos, item);
+        size_t      cnt = h.count + 1u, mid = cnt / 2;
+        uint32_t    right = static_cast<uint32_t>(bf_.allocatePage());
+        {
+            PagePin pin = gBufPool.pinNew(bf_.id(), right);
+            auto    rg  = pin.latch(Latch::Exclusive);
+            char*   rn  = rg.mutPage().raw();
+            std::memset(rn, 0, PAGE_SIZE);
+            setHeader(rn, 0, cnt - mid - 1, childAt(all.data() + mid * S + E));
+            std::memcpy(rn + kNode, all.data() + (mid + 1) * S, (cnt - mid - 1) * S);
+            if (lsn) rg.setLsn(lsn);
+        }
+        std::memcpy(node + kNode, all.data(), mid * S);
+        setHeader(node, 0, mid, h.link);
+        sep.assign(all, mid * S, E);
+        child = right;
+    }
+    root_ = newRoot(root_, sep, child, lsn);           // the root itself split
+}
+
+uint32_t BTree::newRoot(uint32_t left, const std::string& sep, uint32_t right, uint64_t lsn)
+{
+    uint32_t root = static_cast<uint32_t>(bf_.allocatePage());
+    PagePin  pin  = gBufPool.pinNew(bf_.id(), root);
+    auto     g    = pin.latch(Latch::Exclusive);
+    char*    node = g.mutPage().raw();
+    std::memset(node, 0, PAGE_SIZE);
+    setHeader(node, 0, 1, left);
+    std::memcpy(node + kNode, sep.data(), sep.size());
+    std::memcpy(node + kNode + sep.size(), &right, sizeof right);
+    if (lsn) g.setLsn(lsn);
+    ++height_;
+    return root;
+}
+
+void BTree::build(const std::vector<const char*>& sorted)
+{
+    constexpr size_t kRun = 64;                        // pages per pwritev, as COPY
+
+    std::unique_lock lock(mtx_);
+    if (height_ != 0) throw StorageError("index " + bf_.path().string() + " is not empty");
+    if (sorted.empty()) { writeMeta(0); return; }
+
+    const size_t E = entrySize(), S = E + sizeof(uint32_t);
+    std::vector<Page>        run(kRun);
+    std::vector<const char*> bufs;
+    size_t runFirst = bf_.pageCount(), used = 0;
+    auto writeRun = [&] {
+        bufs.clear();
+        for (size_t i = 0; i < used; ++i) bufs.push_back(run[i].raw());
+        bf_.writeDirect(runFirst, bufs);
+        runFirst += used;
+        used = 0;
+    };
+    auto fresh = [&](uint32_t& page) {                 // next page, zeroed
+        if (used == kRun) writeRun();
+        page = static_cast<uint32_t>(bf_.allocatePage());
+        char* node = run[used++].raw();
+        std::memset(node, 0, PAGE_SIZE);
+        return node;
+    };
+
+    // leaves, packed and chained; then each inner level over the one below
+    struct Child { const char* first; uint32_t page; };
+    std::vector<Child> level;
+    for (size_t i = 0; i < sorted.size(); i += leafCap()) {
+        size_t   n = std::min(leafCap(), sorted.size() - i);
+        uint32_t page;
+        char*    node = fresh(page);
+        setHeader(node, 1, n, i + n < sorted.size() ? page + 1 : 0);
+        for (size_t j = 0; j < n; ++j) std::memcpy(node + kNode + j * E, sorted[i + j], E);
+        level.push_back({sorted[i], page});
+    }
+    uint16_t height = 1;
+    while (level.size() > 1) {
+        std::vector<Child> up;
+        for (size_t i = 0; i < level.size(); i += innerCap() + 1) {
+            size_t   n = std::min(innerCap() + 1, level.size() - i);
+            uint32_t page;
+            char*    node = fresh(page);
+            setHeader(node, 0, n - 1, level[i].page);
+            for (size_t j = 1; j < n; ++j) {
+                std::memcpy(node + kNode + (j - 1) * S, level[i + j].first, E);
+                std::memcpy(node + kNode + (j - 1) * S + E, &level[i + j].page, sizeof(uint32_t));
+            }
+            up.push_back({level[i].first, page});
+        }
+        level.swap(up);
+        ++height;
+    }
+    if (used) writeRun();
+    bf_.sync();                                        // nodes before the meta page points at them
+
+    root_    = level[0].page;
+    height_  = height;
+    entries_ = sorted.size();
+    writeMeta(0);
+}
+
+bool BTree::bounds(std::string& lo, std::string& hi) const
+{
+    std::shared_lock lock(mtx_);
+    if (entries_ == 0) return false;
+    const size_t S = entrySize() + sizeof(uint32_t);
+    for (bool left : {true, false}) {
+        uint32_t n = root_;
+        for (uint16_t level = height_; level > 1; --level) {
+            auto       g = gBufPool.fetch(bf_.id(), n, Latch::Shared);
+            NodeHeader h = header(g.page().raw());
+            n = left || h.count == 0 ? h.link
+                                     : childAt(g.page().raw() + kNode + (h.count - 1) * S + entrySize());
+        }
+        auto       g = gBufPool.fetch(bf_.id(), n, Latch::Shared);
+        NodeHeader h = header(g.page().raw());
+        const char* e = g.page().raw() + kNode + (left ? 0 : h.count - 1u) * entrySize();
+        (left ? lo : hi).assign(e, width_);
+    }
+    return true;
+}
+
+/* ─── BTree::Cursor ─────────────────────────────────────────── */
+
+BTree::Cursor::Cursor(const BTree& tree, const std::string& lo, const std::string& hi)
+    : tree_(&tree), hi_(hi)
+{
+    std::string probe(tree.entrySize(), '\0');         // lowest rid of `lo`
+    std::memcpy(probe.data(), lo.data(), std::min<size_t>(lo.size(), tree.width_));
+    seek(probe, false);
+}
+
+void BTree::Cursor::seek(const std::string& probe, bool after)
+{
+    std::shared_lock lock(tree_->mtx_);
+    pos_ = count_ = 0;
+    link_ = 0;
+    if (tree_->height_ == 0) return;
+
+    const size_t E    = tree_->entrySize();
+    uint32_t     leaf = tree_->descend(probe.data(), nullptr);
+    for (bool first = true; first || (pos_ == count_ && link_); first = false) {
+        tree_->bf_.readPage(first ? leaf : link_, copy_);
+        NodeHeader h = header(copy_.raw());
+        count_ = h.count;
+        link_  = h.link;
+        pos_   = first ? static_cast<uint16_t>(search(copy_.raw(), count_, E, probe.data(), E, after)) : 0;
+    }
+}
+
+bool BTree::Cursor::next(Rid& rid)
+{
+    const size_t E = tree_->entrySize();
+    const size_t w = tree_->width_;
+    if (pos_ == count_) {                              // leaf done: find the next entry afresh
+        if (!link_) return false;
+        seek(last_, true);
+        if (pos_ == count_) return false;
+    }
+    const char* e = copy_.raw() + kNode + size_t(pos_) * E;
+    if (!hi_.empty() && std::memcmp(e, hi_.data(), w) > 0) {
+        pos_ = count_;
+        link_ = 0;
+        return false;
+    }
+    last_.assign(e, E);
+    ++pos_;
+    rid = ridOf(e, tree_->width_);
+    return true;
+}
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,66 @@
+#include "BackgroundFlush.hpp"
+#include <algorithm>
+
+namespace elvoiddb::storage {
+
+BackgroundFlusher::BackgroundFlusher(WriteBack wb, size_t capacity, Config cfg)
+    : writeBack_(std::move(wb)), cfg_(cfg),
+      highWater_(std::max<size_t>(1, static_cast<size_t>(capacity * cfg.dirtyRatio)))
+{
+    thread_ = std::thread([this] { run(); });
+}
+
+BackgroundFlusher::~BackgroundFlusher()
+{
+    {
+        std::scoped_lock lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void BackgroundFlusher::noteDirty(PageId id)
+{
+    bool wake;
+    {
+        std::scoped_lock lock(mtx_);
+        dirty_.push_back(id);
+        wake = dirty_.size() == highWater_;
+    }
+    if (wake) cv_.notify_one();
+}
+
+void BackgroundFlusher::kick()
+{
+    {
+        std::scoped_lock lock(mtx_);
+        kicked_ = true;
+    }
+    cv_.notify_one();
+}
+
+void BackgroundFlusher::run()
+{
+    std::vector<PageId> batch;
+    std::unique_lock lock(mtx_);
+    while (!stop_) {
+        cv_.wait_for(lock, cfg_.interval,
+                     [&] { return stop_ || kicked_ || dirty_.size() >= highWater_; });
+        if (stop_) break;
+        kicked_ = false;
+        if (dirty_.empty()) continue;
+
+        batch.swap(dirty_);
+        lock.unlock();
+        try {
+            writeBack_(batch);                  // sorts, batches, submits
+        } catch (...) {
+            // page stays dirty; eviction or flushAll will retry (and throw)
+        }
+        batch.clear();
+        lock.lock();
+    }
+}
+
+} // namespace elvoiddb::storage
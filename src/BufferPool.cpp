@@ -1,90 +1,482 @@
 #include "BufferPool.hpp"
-#include "Storage.hpp"   // for BlockFile
-#include <fstream>
-#include <cstring>
+#include "BackgroundFlush.hpp"
+#include "FileHandle.hpp"
+#include "IoBackend.hpp"
 #include "ThreadPool.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
 
 namespace elvoiddb::storage {
 
-BufferPool gBufPool; // default 64 frames
+// 64 frames; LRU-K keeps full-table scans from flushing the hot set
+BufferPool gBufPool(64, ReplacementPolicy::LruK);
 
-static void rawRead(const fs::path &p, size_t n, Page &pg) {
-    std::ifstream f(p, std::ios::binary);
-    if (!f) {                               // file not yet created
-        std::memset(pg.raw(), 0, PAGE_SIZE);
-        return;
+static void rawRead(FileId file, size_t n, Page &pg) {
+    gHandles.get(file)->readPage(n, pg.raw());     // short read → zero-filled
+}
+
+static void rawWrite(FileId file, size_t n, const Page &pg) {
+    gHandles.get(file)->writePage(n, pg.raw());
+}
+
+/* ─── PageGuard ─────────────────────────────────────────────── */
+
+PageGuard &PageGuard::operator=(PageGuard &&o) noexcept {
+    if (this != &o) {
+        release();
+        pool_ = o.pool_; frame_ = o.frame_; mode_ = o.mode_; dirty_ = o.dirty_;
+        ownsPin_ = o.ownsPin_;
+        o.pool_ = nullptr; o.frame_ = nullptr; o.dirty_ = false;
     }
-    f.seekg(n * PAGE_SIZE);
-    f.read(pg.raw(), PAGE_SIZE);
-    std::streamsize got = f.gcount();
-    if (got < PAGE_SIZE)                    // short read → zero‐fill remainder
-        std::memset(pg.raw() + got, 0, PAGE_SIZE - got);
+    return *this;
 }
 
-static void rawWrite(const fs::path &p, size_t n, const Page &pg) {
-    std::fstream f(p, std::ios::binary | std::ios::in | std::ios::out);
-    if (!f) throw StorageError("rawWrite open fail");
-    f.seekp(n * PAGE_SIZE);
-    f.write(pg.raw(), PAGE_SIZE);
-    if (!f) throw StorageError("rawWrite fail");
-    f.flush();
+void PageGuard::release() {
+    if (!frame_) return;
+    if (mode_ == Latch::Exclusive) {
+        // still latched → the writer cannot capture a half-written page
+        if (dirty_ && !frame_->dirty.exchange(true)) pool_->noteDirty(*frame_);
+        frame_->latch.unlock();
+    } else {
+        frame_->latch.unlock_shared();
+    }
+    if (ownsPin_) pool_->unpin(*frame_);
+    frame_ = nullptr;
+    dirty_ = false;
+}
+
+/* ─── PagePin ───────────────────────────────────────────────── */
+
+PagePin &PagePin::operator=(PagePin &&o) noexcept {
+    if (this != &o) {
+        release();
+        pool_ = o.pool_; frame_ = o.frame_;
+        o.pool_ = nullptr; o.frame_ = nullptr;
+    }
+    return *this;
+}
+
+PageGuard PagePin::latch(Latch mode) const {
+    return pool_->latchFrame(*frame_, mode, false);
+}
+
+void PagePin::release() {
+    if (!frame_) return;
+    pool_->unpin(*frame_);
+    frame_ = nullptr;
+}
+
+/* ─── BufferPool ────────────────────────────────────────────── */
+
+BufferPool::BufferPool(size_t m, ReplacementPolicy policy, size_t shards)
+    : max_(m), policy_(policy), io_(&ioBackend()), raWindow_(std::min<size_t>(32, m / 4)) {
+    if (shards == 0) shards = std::clamp<size_t>(m / 8, 1, 16);
+    shards = std::min(shards, std::max<size_t>(m, 1));
+    for (size_t i = 0; i < shards; ++i) {
+        auto sh = std::make_unique<Shard>();
+        sh->cap = m / shards + (i < m % shards ? 1 : 0);
+        sh->replacer = makeReplacer(policy, sh->cap);
+        shards_.push_back(std::move(sh));
+    }
+    flusher_ = std::make_unique<BackgroundFlusher>(
+        [this](std::vector<PageId> &ids) { writeBack(ids); }, m, BackgroundFlusher::Config{});
+}
+
+BufferPool::~BufferPool() {
+    {
+        // queued read-ahead tasks point at this pool
+        std::unique_lock lock(raMtx_);
+        raIdle_.wait(lock, [&] { return raInflight_ == 0; });
+    }
+    flusher_.reset();                              // no write-back past this point
+    for (auto &sp : shards_)
+        for (Frame &f : sp->frames) io_->unregisterBuffer(f.ioBuf);
 }
 
 void BufferPool::flushFrame(const Frame &f) const {
-    rawWrite(f.id.path, f.id.no, f.page);
+    rawWrite(f.id.file(), f.id.no(), f.page);
 }
 
-Page &BufferPool::get(const fs::path &file, size_t n) {
-    std::scoped_lock lock(mtx_);
+bool BufferPool::evictOne(Shard &s, std::unique_lock<std::mutex> &lock) {
+    // a clean victim can go without any I/O
+    auto clean = [&](size_t i) { const Frame &f = s.frames[i]; return f.pin == 0 && !f.dirty; };
+    if (auto v = s.replacer->victim(clean)) {
+        Frame &f = s.frames[*v];
+        s.map.erase(f.id);
+        s.replacer->remove(*v);
+        s.free.push_back(static_cast<uint32_t>(*v));
+        f.loaded = false;
+        return true;
+    }
+
+    auto unpinned = [&](size_t i) { return s.frames[i].pin == 0; };
+    auto v = s.replacer->victim(unpinned);
+    if (!v) return false;                          // everything pinned
+
+    // only dirty frames left: write one back outside the shard mutex; the
+    // caller re-checks the map because others may have run meanwhile
+    Frame *dirtyVictim = &s.frames[*v];
+    dirtyVictim->pin++;
+    s.syncWrites++;
+    flusher_->kick();                              // writer is falling behind
+    lock.unlock();
+    {
+        std::shared_lock latch(dirtyVictim->latch);
+        logBeforeWrite(dirtyVictim->lsn);
+        flushFrame(*dirtyVictim);
+        dirtyVictim->dirty = false;
+    }
+    dirtyVictim->pin--;
+    lock.lock();
+    return true;
+}
+
+Frame &BufferPool::install(Shard &s, PageId id, uint64_t key) {
+    uint32_t slot;
+    if (!s.free.empty()) { slot = s.free.back(); s.free.pop_back(); }
+    else {
+        slot = static_cast<uint32_t>(s.frames.size());
+        // deque never moves a frame, so its page can be a registered buffer
+        Frame &nf = s.frames.emplace_back();
+        nf.ioBuf = io_->registerBuffer(nf.page.raw());
+    }
+    Frame &f = s.frames[slot];
+    f.id = id; f.pin = 1; f.dirty = false; f.loaded = false; f.prefetched = false; f.lsn = 0;
+    s.map[id] = slot;
+    s.replacer->recordAccess(slot, key, true);
+    return f;
+}
+
+Frame &BufferPool::pin(FileId file, size_t n, bool fresh, bool &latched) {
     PageId id{file, n};
-    if (auto it = map_.find(id); it != map_.end()) {
-        lru_.splice(lru_.begin(), lru_, it->second); // MRU
-        it->second->pin++;
-        return it->second->page;
-    }
-
-    if (lru_.size() >= max_) {
-        auto rit = lru_.rbegin();
-        while (rit != lru_.rend() && rit->pin != 0) ++rit;
-        if (rit == lru_.rend()) throw StorageError("all pages pinned");
-        if (rit->dirty) flushFrame(*rit);
-        map_.erase(rit->id);
-        lru_.erase(std::next(rit).base());
-    }
-
-    lru_.push_front(Frame{});
-    Frame &f = lru_.front();
-    f.id = id; f.pin = 1; f.dirty = false;
-    rawRead(file, n, f.page);
-    map_[id] = lru_.begin();
-    return f.page;
-}
-
-void BufferPool::markDirty(const fs::path &file, size_t n) {
-    std::scoped_lock lock(mtx_);
-    if (auto it = map_.find(PageId{file, n}); it != map_.end()) it->second->dirty = true;
-}
-
-void BufferPool::unpin(const fs::path &file, size_t n) {
-    std::scoped_lock lock(mtx_);
-    auto it = map_.find(PageId{file, n});
-    if (it != map_.end() && it->second->pin) {
-        it->second->pin--;
-        /*  ── NEW: if page is dirty and no pins left, flush async ── */
-        if (it->second->pin == 0 && it->second->dirty) {
-            Frame *fptr = &(*it->second);            // capture raw ptr
-            util::gThreadPool.submit([this, fptr] {
-                std::scoped_lock lk(mtx_);
-                flushFrame(*fptr);
-                fptr->dirty = false;
-            });
+    uint64_t key = PageIdHash{}(id);
+    Shard &s = shardFor(id);
+    std::unique_lock lock(s.mtx);
+    latched = false;
+
+    for (;;) {
+        if (auto it = s.map.find(id); it != s.map.end()) {
+            Frame &f = s.frames[it->second];
+            f.pin++;
+            s.hits++;
+            // the read-ahead counted as the first reference; keep sliding
+            // the window while the scan consumes it
+            if (f.prefetched) {
+                f.prefetched = false;
+                lock.unlock();
+                if (!fresh) readAhead(id);
+                return f;
+            }
+            s.replacer->recordAccess(it->second, key, false);
+            return f;
+        }
+        // a shard whose frames are all pinned grows past its share rather
+        // than failing; it shrinks back on later misses
+        if (s.map.size() < s.cap || !evictOne(s, lock)) break;
+    }
+
+    s.misses++;
+    Frame &f = install(s, id, key);
+    if (fresh) {                                   // past EOF: nothing to read
+        f.page = Page(); f.loaded = true; f.dirty = true;
+        lock.unlock();
+        noteDirty(f);
+        return f;
+    }
+
+    // publish the frame latched so concurrent pinners wait for the read,
+    // then do the I/O without the shard mutex
+    f.latch.lock();
+    latched = true;
+    lock.unlock();
+    readAhead(id);                                 // overlaps with our own read
+    try {
+        load(f);
+    } catch (...) {
+        f.latch.unlock();
+        unpin(f);                                  // stays !loaded; next user retries
+        throw;
+    }
+    return f;
+}
+
+void BufferPool::load(Frame &f) {
+    rawRead(f.id.file(), f.id.no(), f.page);
+    f.loaded = true;
+}
+
+PageGuard BufferPool::latchFrame(Frame &f, Latch mode, bool ownsPin) {
+    f.latch.lock();
+    if (!f.loaded) {                               // an earlier read failed
+        try { load(f); }
+        catch (...) {
+            f.latch.unlock();
+            if (ownsPin) unpin(f);
+            throw;
         }
     }
+    if (mode == Latch::Shared) {
+        f.latch.unlock();
+        f.latch.lock_shared();
+    }
+    return PageGuard(this, &f, mode, ownsPin);
+}
+
+PageGuard BufferPool::fetch(FileId file, size_t n, Latch mode) {
+    bool latched;
+    Frame &f = pin(file, n, false, latched);
+    if (!latched) {
+        if (mode == Latch::Shared) {
+            f.latch.lock_shared();
+            if (f.loaded) return PageGuard(this, &f, mode);
+            f.latch.unlock_shared();
+        }
+        return latchFrame(f, mode, true);
+    }
+    if (mode == Latch::Shared) {                   // we loaded it: downgrade
+        f.latch.unlock();
+        f.latch.lock_shared();
+    }
+    return PageGuard(this, &f, mode);
+}
+
+PagePin BufferPool::pinPage(FileId file, size_t n) {
+    bool latched;
+    Frame &f = pin(file, n, false, latched);
+    if (latched) f.latch.unlock();
+    return PagePin(this, &f);
+}
+
+PagePin BufferPool::pinNew(FileId file, size_t n) {
+    bool latched;
+    Frame &f = pin(file, n, true, latched);
+    if (!f.dirty) {                                // stale frame from an old file
+        std::unique_lock latch(f.latch);
+        f.page = Page(); f.loaded = true; f.dirty = true;
+        noteDirty(f);
+    }
+    return PagePin(this, &f);
+}
+
+/* ─── Read-ahead ────────────────────────────────────────────── */
+
+void BufferPool::setReadAhead(size_t pages) {
+    raWindow_ = std::min(pages, max_ / 2);         // leave room for the scan itself
+}
+
+void BufferPool::adviseSequential(FileId file, size_t from) {
+    size_t win = raWindow_;
+    if (win == 0) return;
+    {
+        std::scoped_lock lock(raMtx_);
+        if (file >= seq_.size()) seq_.resize(file + 1);
+        SeqState &st = seq_[file];
+        st.last  = from - 1;                       // `from` itself counts as sequential
+        st.run   = 1;
+        st.ahead = from + win;
+        raInflight_++;
+    }
+    postPrefetch(file, from, win);
+}
+
+void BufferPool::readAhead(PageId id) {
+    size_t win = raWindow_;
+    if (win == 0) return;
+    FileId file = id.file();
+    size_t n = id.no(), first, count;
+    {
+        std::scoped_lock lock(raMtx_);
+        if (file >= seq_.size()) seq_.resize(file + 1);
+        SeqState &st = seq_[file];
+        if (st.run && n == st.last + 1) st.run++;
+        else { st.run = 1; st.ahead = 0; }         // random access: forget the window
+        st.last = n;
+        // two sequential reports start it; then top up once half is consumed
+        if (st.run < 2 || st.ahead > n + win / 2) return;
+        first    = std::max(st.ahead, n + 1);
+        st.ahead = n + 1 + win;
+        count    = st.ahead - first;
+        raInflight_++;
+    }
+    postPrefetch(file, first, count);
+}
+
+void BufferPool::postPrefetch(FileId file, size_t first, size_t count) {
+    // the task holds its own handle: it may run after the table is closed,
+    // or at exit after gHandles is gone
+    std::shared_ptr<FileHandle> fh;
+    try {
+        fh = gHandles.get(file);
+    } catch (const StorageError &) {
+        std::scoped_lock lock(raMtx_);
+        if (--raInflight_ == 0) raIdle_.notify_all();
+        return;
+    }
+    util::gThreadPool.post([this, fh = std::move(fh), file, first, count] {
+        prefetchTask(fh, file, first, count);
+    });
+}
+
+void BufferPool::prefetchTask(const std::shared_ptr<FileHandle> &fh, FileId file, size_t first, size_t count) {
+    try {
+        prefetch(*fh, file, first, count);
+    } catch (...) {
+        // best effort: a failed page stays !loaded and the reader retries
+    }
+    std::scoped_lock lock(raMtx_);
+    if (--raInflight_ == 0) raIdle_.notify_all();
+}
+
+Frame *BufferPool::reserve(FileId file, size_t n) {
+    PageId id{file, n};
+    Shard &s = shardFor(id);
+    std::unique_lock lock(s.mtx);
+    for (;;) {
+        if (s.map.count(id)) return nullptr;       // resident or already in flight
+        if (s.map.size() < s.cap) break;
+        if (!evictOne(s, lock)) return nullptr;    // never grow a shard for a guess
+    }
+    Frame &f = install(s, id, PageIdHash{}(id));
+    f.prefetched = true;
+    f.latch.lock();                                // readers wait for the preadv
+    s.prefetched++;
+    return &f;
+}
+
+void BufferPool::prefetch(FileHandle &fh, FileId file, size_t first, size_t count) {
+    size_t end = std::min(first + count, fh.pageCount());    // never past EOF
+
+    // claim every absent page first, then read them as one batch
+    std::vector<Frame *> claimed;
+    for (size_t n = first; n < end; ++n)
+        if (Frame *f = reserve(file, n)) claimed.push_back(f);
+    if (claimed.empty()) return;
+
+    std::vector<PageIo> ops;
+    for (Frame *f : claimed)
+        ops.push_back({&fh, f->id.no(), f->page.raw(), f->ioBuf, false, 0});
+    try {
+        io_->submit(ops);
+    } catch (...) {
+        for (auto &op : ops) op.result = -EIO;
+    }
+    for (size_t i = 0; i < claimed.size(); ++i) {
+        claimed[i]->loaded = ops[i].result == 0;   // failed → reader retries the load
+        claimed[i]->latch.unlock();
+        unpin(*claimed[i]);
+    }
+}
+
+void BufferPool::noteDirty(const Frame &f) {
+    flusher_->noteDirty(f.id);
+}
+
+void BufferPool::writeBack(std::vector<PageId> &ids) {
+    // PageId keys order by (file, page), so adjacent pages end up adjacent
+    std::sort(ids.begin(), ids.end(), [](PageId a, PageId b) { return a.key < b.key; });
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    // pin one batch at a time so write-back never starves the foreground
+    const size_t maxBatch = flusher_->config().maxBatch;
+    std::vector<Frame *> batch;
+    bool ok = true;
+    for (PageId id : ids) {
+        {
+            Shard &s = shardFor(id);
+            std::scoped_lock lock(s.mtx);
+            auto it = s.map.find(id);
+            if (it == s.map.end() || !s.frames[it->second].dirty) continue;   // evicted or clean
+            Frame &f = s.frames[it->second];
+            f.pin++;                               // keep it resident during I/O
+            batch.push_back(&f);
+        }
+        if (batch.size() == maxBatch) ok &= writeBatch(batch);
+    }
+    if (!batch.empty()) ok &= writeBatch(batch);
+    if (!ok) throw StorageError("write-back failed");   // pages stay dirty
+}
+
+bool BufferPool::writeBatch(std::vector<Frame *> &batch) {
+    // shared latches in page order; page writers hold one latch at a time
+    std::vector<std::shared_ptr<FileHandle>> files;
+    std::vector<PageId> pageIds;
+    std::vector<PageIo> ops;
+    bool ok = true;
+    for (Frame *f : batch) {
+        f->latch.lock_shared();
+        pageIds.push_back(f->id);
+    }
+    for (size_t i = 0; i < batch.size(); ++i) {
+        FileId file = pageIds[i].file();
+        if (i == 0 || pageIds[i - 1].file() != file) {
+            try { files.push_back(gHandles.get(file)); }
+            catch (const StorageError &) { files.push_back(nullptr); }
+        }
+        if (!files.back()) { ok = false; continue; }   // closed file: drop the write
+        ops.push_back({files.back().get(), pageIds[i].no(), batch[i]->page.raw(),
+                       batch[i]->ioBuf, true, 0});
+    }
+    size_t calls = 0;
+    try {
+        uint64_t lsn = 0;
+        for (Frame *f : batch) lsn = std::max<uint64_t>(lsn, f->lsn);
+        logBeforeWrite(lsn);
+        calls = io_->submit(ops);
+    } catch (const StorageError &) {
+        for (auto &op : ops) op.result = -EIO;
+    }
+
+    size_t j = 0, written = 0;
+    for (Frame *f : batch) {
+        if (j < ops.size() && ops[j].buf == f->page.raw()) {
+            if (ops[j].result == 0) { f->dirty = false; ++written; }   // writers need the exclusive latch
+            else                    ok = false;
+            ++j;
+        }
+        f->latch.unlock_shared();
+        unpin(*f);
+    }
+    bgPages_ += written;
+    bgCalls_ += calls;
+    batch.clear();
+    return ok;
 }
 
 void BufferPool::flushAll() {
-    std::scoped_lock lock(mtx_);
-    for (auto &f : lru_) if (f.dirty) flushFrame(f);
+    {
+        // let queued read-ahead finish before the caller tears files down
+        std::unique_lock lock(raMtx_);
+        raIdle_.wait(lock, [&] { return raInflight_ == 0; });
+    }
+    std::vector<PageId> dirty;
+    for (auto &sp : shards_) {
+        std::scoped_lock lock(sp->mtx);
+        for (auto &[id, slot] : sp->map)
+            if (sp->frames[slot].dirty) dirty.push_back(id);
+    }
+    writeBack(dirty);
+}
+
+BufferPool::Stats BufferPool::stats() {
+    Stats st{0, 0};
+    for (auto &sp : shards_) {
+        std::scoped_lock lock(sp->mtx);
+        st.hits += sp->hits; st.misses += sp->misses; st.syncWrites += sp->syncWrites;
+        st.prefetched += sp->prefetched;
+    }
+    st.bgPages = bgPages_;
+    st.bgCalls = bgCalls_;
+    return st;
+}
+
+void BufferPool::resetStats() {
+    for (auto &sp : shards_) {
+        std::scoped_lock lock(sp->mtx);
+        sp->hits = sp->misses = sp->syncWrites = sp->prefetched = 0;
+    }
+    bgPages_ = bgCalls_ = 0;
 }
 
 } // namespace elvoiddb::storage
@@ -1,11 +1,15 @@
 #include "Commands.hpp"
+#include "CsvReader.hpp"
+#include "Index.hpp"
+#include "Join.hpp"
+#include "ParallelScan.hpp"
+#include "Wal.hpp"
 #include <iostream>
 #include <algorithm>
 
 namespace elvoiddb {
 
-std::unordered_map<std::string, MemTable> gMemDB;
-storage::FileManager                       gFileMgr;
+storage::FileManager gFileMgr;
 
 /* helpers */
 static void printRow(const std::vector<std::string>& row)
@@ -14,62 +18,288 @@ static void printRow(const std::vector<std::string>& row)
         std::cout << row[i] << (i + 1 == row.size() ? '\n' : '\t');
 }
 
+static storage::TableFile& openTable(const std::string& name)
+{
+    auto* tf = gFileMgr.openTable(name);
+    if (!tf) throw ExecutionError("no such table");
+    return *tf;
+}
+
 /* CREATE TABLE */
-CreateTableCmd::CreateTableCmd(std::string n, std::vector<std::string> c)
-    : name_(std::move(n)), cols_(std::move(c)) {}
+CreateTableCmd::CreateTableCmd(std::string n, std::vector<std::string> c,
+                               storage::PageLayout layout)
+    : name_(std::move(n)), cols_(std::move(c)), layout_(layout) {}
 
 void CreateTableCmd::execute()
 {
-    if (gMemDB.count(name_)) throw ExecutionError("table exists in mem");
-    gFileMgr.createTable(name_, cols_);
-    gMemDB[name_] = MemTable{cols_, {}};
+    gFileMgr.createTable(name_, cols_, layout_);
+    storage::gWal.commit();
     std::cout << "Table '" << name_ << "' created.\n";
 }
 
-static MemTable& ensureLoaded(const std::string& name)
-{
-    auto it = gMemDB.find(name);
-    if (it == gMemDB.end()) {
-        auto* tf = gFileMgr.openTable(name);
-        if (!tf) throw ExecutionError("no such table");
-
-        auto cols = tf->columnList();
-        if (cols.empty()) throw ExecutionError("corrupt table header");
+/* CREATE INDEX */
+CreateIndexCmd::CreateIndexCmd(std::string n, std::string table, std::string column,
+                               storage::IndexKind kind)
+    : name_(std::move(n)), table_(std::move(table)), column_(std::move(column)), kind_(kind) {}
 
-        it = gMemDB.emplace(name, MemTable{cols, {}}).first;
-        tf->loadAllRows(it->second.rows);              // first (and only) load
-    }
-    return it->second;
+void CreateIndexCmd::execute()
+{
+    auto& tf = openTable(table_);
+    if (tf.schema().size() == 0) throw ExecutionError("corrupt table header");
+    tf.createIndex(name_, column_, kind_);
+    storage::gWal.commit();
+    std::cout << "Index '" << name_ << "' created.\n";
 }
 
-
 /* INSERT INTO */
-InsertCmd::InsertCmd(std::string n, std::vector<std::string> v)
-    : name_(std::move(n)), values_(std::move(v)) {}
+InsertCmd::InsertCmd(std::string n, std::vector<std::vector<std::string>> rows)
+    : name_(std::move(n)), rows_(std::move(rows)) {}
 
 void InsertCmd::execute()
 {
-    auto& tbl = ensureLoaded(name_);
+    auto& tf = openTable(name_);
+    const size_t ncols = tf.schema().size();
+    if (ncols == 0) throw ExecutionError("corrupt table header");
+
+    for (const auto& row : rows_)                      // all or nothing
+        if (row.size() != ncols)
+            throw ExecutionError("column count mismatch");
+
+    tf.appendRows(rows_);                              // typed; throws if read-only
+    storage::gWal.commit();                            // one wait for the whole batch
+    storage::gWal.maybeCheckpoint();
+
+    if (rows_.size() == 1) std::cout << "1 row inserted.\n";
+    else                   std::cout << rows_.size() << " rows inserted.\n";
+}
+
+/* COPY name FROM 'file' */
+CopyCmd::CopyCmd(std::string n, std::string path, char delim, bool header)
+    : name_(std::move(n)), path_(std::move(path)), delim_(delim), header_(header) {}
+
+void CopyCmd::execute()
+{
+    auto& tf = openTable(name_);
+    const auto&  schema = tf.schema();
+    const size_t ncols  = schema.size();
+    if (ncols == 0) throw ExecutionError("corrupt table header");
 
-    if (values_.size() != tbl.columns.size())
-        throw ExecutionError("column count mismatch");
+    util::CsvReader in(path_, delim_);
+    std::vector<std::string_view> fields;
+    if (header_) in.next(fields);
 
-    tbl.rows.push_back(values_);                       // RAM
-    if (auto* tf = gFileMgr.openTable(name_))
-        tf->appendRow(values_);                        // disk
+    size_t rows = tf.bulkAppend([&](std::string& rec) {
+        if (!in.next(fields)) return false;
+        auto where = [&] { return "record " + std::to_string(in.record()) + ": "; };
+        if (fields.size() != ncols)
+            throw ExecutionError(where() + "expected " + std::to_string(ncols) +
+                                 " fields, got " + std::to_string(fields.size()));
+        try {
+            schema.encode(fields, rec, storage::Literal::Csv);
+        } catch (const ExecutionError& e) {
+            throw ExecutionError(where() + e.what());
+        }
+        return true;
+    });
+    storage::gWal.commit();
+    storage::gWal.maybeCheckpoint();
 
-    std::cout << "1 row inserted.\n";
+    std::cout << rows << " rows copied.\n";
 }
 
-/* SELECT * FROM */
-SelectCmd::SelectCmd(std::string n) : name_(std::move(n)) {}
+/* SELECT */
+static size_t columnOf(const storage::Schema& s, const std::string& name)
+{
+    for (size_t i = 0; i < s.size(); ++i)
+        if (s[i].name == name) return i;
+    throw ExecutionError("no column " + name);
+}
+
+SelectCmd::SelectCmd(std::string n, std::unique_ptr<storage::Predicate> where,
+                     std::vector<SelectItem> items, std::vector<std::string> groupBy)
+    : name_(std::move(n)), where_(std::move(where)), items_(std::move(items)), groupBy_(std::move(groupBy)) {}
 
 void SelectCmd::execute()
 {
-    auto& tbl = ensureLoaded(name_);
+    auto& tf = openTable(name_);
+    if (tf.schema().size() == 0) throw ExecutionError("corrupt table header");
+
+    if (where_) where_->bind(tf.schema());            // unknown columns fail before output
+    if (!groupBy_.empty() || std::any_of(items_.begin(), items_.end(), [](auto& i) { return i.agg; })) {
+        aggregate(tf);
+        return;
+    }
+
+    std::vector<size_t> cols;                          // printed, in order
+    for (const auto& item : items_) cols.push_back(columnOf(tf.schema(), item.column));
+    if (items_.empty())
+        for (size_t i = 0; i < tf.schema().size(); ++i) cols.push_back(i);
+    std::vector<std::string> names;
+    for (size_t c : cols) names.push_back(tf.schema()[c].name);
+    printRow(names);
+
+    auto format = [&cols](const storage::RowRef& row, std::string& out) {
+        for (size_t k = 0; k < cols.size(); ++k) {
+            if (k) out += '\t';
+            row.format(cols[k], out);
+        }
+        out += '\n';
+    };
+
+    // a selective condition on an indexed column: fetch just those rows
+    if (auto ix = where_ ? storage::IndexScan::plan(tf, *where_) : nullptr) {
+        storage::RowRef row;
+        std::string     line;
+        while (ix->next(row)) {
+            line.clear();
+            format(row, line);
+            std::cout << line;
+        }
+        return;
+    }
+    // morsels of pages filtered and formatted on the pool's threads,
+    // printed in table order
+    storage::ParallelScan scan(tf, where_.get());
+    scan.runOrdered(
+        [&](size_t, storage::TableScan& morsel, std::string& out) {
+            storage::RowRef row;
+            while (morsel.next(row)) format(row, out);
+        },
+        [](const std::string& out) { std::cout << out; });
+}
+
+// aggregates (and GROUP BY): each scan thread folds its morsels into a
+// HashAggregate of its own; the partials are merged once at the end
+void SelectCmd::aggregate(storage::TableFile& tf)
+{
+    const storage::Schema& s = tf.schema();
+    std::vector<size_t> keys;
+    for (const auto& name : groupBy_) keys.push_back(columnOf(s, name));
+
+    std::vector<storage::AggSpec> aggs;
+    std::vector<size_t>           pick;                // SELECT item → result field
+    std::vector<std::string>      names;
+    for (const auto& item : items_) {
+        if (!item.agg) {
+            columnOf(s, item.column);
+            auto at = std::find(groupBy_.begin(), groupBy_.end(), item.column);
+            if (at == groupBy_.end()) throw ExecutionError(item.column + " must appear in GROUP BY");
+            pick.push_back(static_cast<size_t>(at - groupBy_.begin()));
+            names.push_back(item.column);
+            continue;
+        }
+        aggs.push_back({item.fn, item.column == "*" ? storage::AggSpec::kStar : columnOf(s, item.column)});
+        pick.push_back(keys.size() + aggs.size() - 1);
+        names.push_back(storage::HashAggregate::label(aggs.back(), s));
+    }
+    if (items_.empty()) throw ExecutionError("SELECT * cannot be grouped");
+
+    storage::ParallelScan scan(tf, where_.get());
+    std::vector<std::unique_ptr<storage::HashAggregate>> parts;   // per scan thread
+    for (size_t w = 0; w < scan.threads(); ++w)
+        parts.push_back(std::make_unique<storage::HashAggregate>(s, keys, aggs));
+
+    storage::RowRef row;
+    if (auto ix = where_ ? storage::IndexScan::plan(tf, *where_) : nullptr) {
+        while (ix->next(row)) parts[0]->add(row);
+    } else {
+        scan.run([&](size_t worker, size_t, storage::TableScan& morsel) {
+            storage::RowRef r;
+            while (morsel.next(r)) parts[worker]->add(r);
+        });
+    }
+    for (size_t w = 1; w < parts.size(); ++w) parts[0]->merge(*parts[w]);
+
+    printRow(names);
+    std::vector<std::string> out(pick.size());
+    for (const auto& result : parts[0]->result()) {
+        for (size_t k = 0; k < pick.size(); ++k) out[k] = result[pick[k]];
+        printRow(out);
+    }
+}
+
+/* SELECT … FROM a JOIN b ON … */
+JoinCmd::JoinCmd(std::string left, std::string right, std::string leftOn, std::string rightOn,
+                 std::unique_ptr<storage::Predicate> where, std::vector<SelectItem> items)
+    : left_(std::move(left)), right_(std::move(right)), leftOn_(std::move(leftOn)),
+      rightOn_(std::move(rightOn)), where_(std::move(where)), items_(std::move(items)) {}
+
+void JoinCmd::execute()
+{
+    if (left_ == right_) throw ExecutionError("cannot join " + left_ + " with itself");
+    storage::TableFile* tf[2] = {&openTable(left_), &openTable(right_)};
+    for (auto* t : tf)
+        if (t->schema().size() == 0) throw ExecutionError("corrupt table header");
+
+    // "t.col" or a "col" only one table has → (table 0 / 1, column)
+    auto resolve = [&](const std::string& name) -> std::pair<int, size_t> {
+        size_t dot = name.find('.');
+        if (dot != std::string::npos) {
+            std::string t = name.substr(0, dot);
+            if (t != left_ && t != right_) throw ExecutionError("no table " + t + " in the join");
+            int side = t == left_ ? 0 : 1;
+            return {side, columnOf(tf[side]->schema(), name.substr(dot + 1))};
+        }
+        int found = -1;
+        for (int side : {0, 1})
+            for (size_t i = 0; i < tf[side]->schema().size(); ++i)
+                if (tf[side]->schema()[i].name == name) {
+                    if (found >= 0) throw ExecutionError("column " + name + " is ambiguous");
+                    found = side;
+                }
+        if (found < 0) throw ExecutionError("no column " + name);
+        return {found, columnOf(tf[found]->schema(), name)};
+    };
+
+    auto on = std::make_pair(resolve(leftOn_), resolve(rightOn_));
+    if (on.first.first == on.second.first) throw ExecutionError("ON must compare a column of each table");
+    if (on.first.first == 1) std::swap(on.first, on.second);
+
+    // each AND-ed part of WHERE filters the one table it names
+    std::unique_ptr<storage::Predicate> where[2];
+    std::vector<std::unique_ptr<storage::Predicate>> parts;
+    if (where_) storage::Predicate::split(std::move(where_), parts);
+    for (auto& part : parts) {
+        int side = -1;
+        part->rename([&](const std::string& name) {
+            auto [s, col] = resolve(name);
+            if (side >= 0 && side != s) throw ExecutionError("each AND-ed part of WHERE must use one table");
+            side = s;
+            return tf[s]->schema()[col].name;
+        });
+        where[side] = where[side] ? storage::Predicate::both(std::move(where[side]), std::move(part))
+                                  : std::move(part);
+    }
+    for (int side : {0, 1})
+        if (where[side]) where[side]->bind(tf[side]->schema());
+
+    std::vector<std::pair<int, size_t>> cols;          // printed, in order
+    std::vector<std::string>            names;
+    for (const auto& item : items_) {
+        if (item.agg) throw ExecutionError("aggregates over a JOIN are not supported");
+        cols.push_back(resolve(item.column));
+        names.push_back(item.column);
+    }
+    if (items_.empty())
+        for (int side : {0, 1})
+            for (size_t i = 0; i < tf[side]->schema().size(); ++i) {
+                cols.push_back({side, i});
+                names.push_back(tf[side]->schema()[i].name);
+            }
 
-    printRow(tbl.columns);
-    for (const auto& r : tbl.rows) printRow(r);
+    storage::JoinSide l{*tf[0], on.first.second, where[0].get()};
+    storage::JoinSide r{*tf[1], on.second.second, where[1].get()};
+    storage::Join     join(l, r, storage::Join::plan(l, r));
+    printRow(names);
+    join.run(
+        [&cols](const storage::RowRef& a, const storage::RowRef& b, std::string& out) {
+            for (size_t k = 0; k < cols.size(); ++k) {
+                if (k) out += '\t';
+                (cols[k].first ? b : a).format(cols[k].second, out);
+            }
+            out += '\n';
+        },
+        [](const std::string& out) { std::cout << out; });
 }
 
 } // namespace elvoiddb
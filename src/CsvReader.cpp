@@ -0,0 +1,119 @@
+#include "CsvReader.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace elvoiddb::util {
+
+CsvReader::CsvReader(const fs::path& p, char delim)
+    : path_(p), delim_(delim), buf_(1 << 20)
+{
+    fd_ = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) throw StorageError("cannot open " + p.string() + ": " + std::strerror(errno));
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+CsvReader::~CsvReader()
+{
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool CsvReader::fill()
+{
+    if (eof_) return false;
+    if (pos_ > 0) {                                      // keep the partial record
+        std::memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+        end_ -= pos_;
+        pos_  = 0;
+    }
+    if (end_ == buf_.size()) buf_.resize(buf_.size() * 2);   // one record fills the buffer
+
+    for (;;) {
+        ssize_t r = ::read(fd_, buf_.data() + end_, buf_.size() - end_);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) throw StorageError("read fail " + path_.string());
+        if (r == 0) { eof_ = true; return false; }
+        end_ += r;
+        return true;
+    }
+}
+
+bool CsvReader::next(std::vector<std::string_view>& fields)
+{
+    for (;;) {
+        if (pos_ == end_ && !fill()) return false;
+        const char* p = buf_.data() + pos_;
+        const char* e = buf_.data() + end_;
+
+        auto* nl = static_cast<const char*>(std::memchr(p, '\n', e - p));
+        if (!nl && !eof_) { fill(); continue; }          // record not complete yet
+        const char* eol = nl ? nl : e;
+
+        if (std::memchr(p, '"', eol - p)) {              // slow path
+            while (!splitQuoted(fields)) {               // quoted newline: read on
+                if (eof_) throw ParseError("record " + std::to_string(record_ + 1) +
+                                           ": unterminated quote");
+                fill();
+            }
+            ++record_;
+            return true;
+        }
+
+        pos_ = nl ? nl - buf_.data() + 1 : end_;
+        if (eol > p && eol[-1] == '\r') --eol;
+        if (eol == p) continue;                          // blank line
+
+        fields.clear();
+        for (const char* q = p;;) {
+            auto* d = static_cast<const char*>(std::memchr(q, delim_, eol - q));
+            if (!d) { fields.emplace_back(q, eol - q); break; }
+            fields.emplace_back(q, d - q);
+            q = d + 1;
+        }
+        ++record_;
+        return true;
+    }
+}
+
+bool CsvReader::splitQuoted(std::vector<std::string_view>& fields)
+{
+    const char* q = buf_.data() + pos_;
+    const char* e = buf_.data() + end_;
+    fields.clear();
+    scratch_.clear();
+    scratch_.reserve(e - q);                             // views below must not move
+
+    for (;;) {
+        if (q < e && *q == '"') {                        // "…", "" is a literal quote
+            size_t start = scratch_.size();
+            for (++q;;) {
+                auto* quote = static_cast<const char*>(std::memchr(q, '"', e - q));
+                if (!quote) { fields.clear(); return false; }
+                scratch_.append(q, quote - q);
+                q = quote + 1;
+                if (q == e && !eof_) { fields.clear(); return false; }
+                if (q < e && *q == '"') { scratch_ += '"'; ++q; continue; }
+                break;
+            }
+            fields.emplace_back(scratch_.data() + start, scratch_.size() - start);
+            if (q < e && *q == '\r') ++q;
+            if (q < e && *q != delim_ && *q != '\n')
+                throw ParseError("record " + std::to_string(record_ + 1) + ": text after closing quote");
+        } else {
+            const char* f = q;
+            while (q < e && *q != delim_ && *q != '\n') ++q;
+            if (q == e && !eof_) { fields.clear(); return false; }
+            const char* fe = q;
+            if (fe > f && fe[-1] == '\r' && (q == e || *q == '\n')) --fe;
+            fields.emplace_back(f, fe - f);
+        }
+
+        if (q == e) break;                               // last record, no newline
+        if (*q++ == '\n') break;
+    }
+    pos_ = q - buf_.data();
+    return true;
+}
+
+} // namespace elvoiddb::util
@@ -0,0 +1,369 @@
+#include "ExtendibleHash.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace elvoiddb::storage {
+
+namespace {
+
+struct BucketHeader {
+    uint16_t count;    // entries on this page
+    uint16_t local;    // hash bits shared by every key in the bucket
+    uint32_t next;     // overflow page, 0 = none
+};
+
+struct Meta {
+    uint32_t magic;
+    uint16_t keyWidth;
+    uint16_t depth;
+    uint64_t entries;
+    uint32_t dirPages; // followed by that many u32 page numbers
+};
+
+constexpr size_t kBucket = sizeof(BucketHeader);
+
+BucketHeader header(const char* page)
+{
+    BucketHeader h;
+    std::memcpy(&h, page, sizeof h);
+    return h;
+}
+
+void setHeader(char* page, size_t count, uint16_t local, uint32_t next)
+{
+    BucketHeader h{static_cast<uint16_t>(count), local, next};
+    std::memcpy(page, &h, sizeof h);
+}
+
+} // namespace
+
+ExtendibleHash::ExtendibleHash(const fs::path& p, bool create, uint16_t keyWidth)
+    : bf_(p, create)
+{
+    if (create) {
+        if (keyWidth == 0 || keyWidth > BTree::kMaxKey) throw StorageError("bad key width for " + p.string());
+        width_ = keyWidth;                             // page 0 has no magic until build()
+        return;
+    }
+    Meta m;
+    {
+        auto g = gBufPool.fetch(bf_.id(), 0, Latch::Shared);
+        const char* raw = g.page().raw();
+        std::memcpy(&m, raw, sizeof m);
+        if (m.magic == kMagic && m.depth <= kMaxDepth &&
+            m.dirPages == ((size_t(1) << m.depth) + kDirSlots - 1) / kDirSlots) {
+            dirPages_.resize(m.dirPages);
+            std::memcpy(dirPages_.data(), raw + sizeof m, m.dirPages * sizeof(uint32_t));
+        }
+    }
+    if (m.magic != kMagic || m.keyWidth == 0 || m.keyWidth > BTree::kMaxKey || dirPages_.empty())
+        throw StorageError("corrupt index " + p.string());
+    width_   = m.keyWidth;
+    depth_   = m.depth;
+    entries_ = m.entries;
+
+    dir_.resize(size_t(1) << depth_);
+    for (size_t i = 0; i < dirPages_.size(); ++i) {
+        if (dirPages_[i] >= bf_.pageCount()) throw StorageError("corrupt index " + p.string());
+        auto   g = gBufPool.fetch(bf_.id(), dirPages_[i], Latch::Shared);
+        size_t n = std::min(kDirSlots, dir_.size() - i * kDirSlots);
+        std::memcpy(dir_.data() + i * kDirSlots, g.page().raw(), n * sizeof(uint32_t));
+    }
+}
+
+size_t ExtendibleHash::bucketCap() const { return (PAGE_SIZE - kBucket) / entrySize(); }
+
+uint64_t ExtendibleHash::hashOf(const char* key) const
+{
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    for (size_t i = 0; i < width_; i += 8) {
+        uint64_t w = 0;
+        std::memcpy(&w, key + i, std::min<size_t>(8, width_ - i));
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;         // fmix64 tail: low bits see every byte
+    h ^= h >> 33;
+    return h;
+}
+
+void ExtendibleHash::writeMeta(uint64_t lsn)
+{
+    Meta m{kMagic, width_, depth_, entries_, static_cast<uint32_t>(dirPages_.size())};
+    auto  g   = gBufPool.fetch(bf_.id(), 0, Latch::Exclusive);
+    char* raw = g.mutPage().raw();
+    std::memcpy(raw, &m, sizeof m);
+    std::memcpy(raw + sizeof m, dirPages_.data(), dirPages_.size() * sizeof(uint32_t));
+    if (lsn) g.setLsn(lsn);
+}
+
+void ExtendibleHash::writeDir(size_t from, size_t to, uint64_t lsn)
+{
+    for (size_t pg = from / kDirSlots; pg * kDirSlots < to; ++pg) {
+        const size_t n = std::min(kDirSlots, dir_.size() - pg * kDirSlots);
+        PagePin   pin;
+        PageGuard g;
+        if (pg == dirPages_.size()) {                  // the directory outgrew its pages
+            dirPages_.push_back(static_cast<uint32_t>(bf_.allocatePage()));
+            pin = gBufPool.pinNew(bf_.id(), dirPages_.back());
+            g   = pin.latch(Latch::Exclusive);
+        } else {
+            g = gBufPool.fetch(bf_.id(), dirPages_[pg], Latch::Exclusive);
+        }
+        std::memcpy(g.mutPage().raw(), dir_.data() + pg * kDirSlots, n * sizeof(uint32_t));
+        if (lsn) g.setLsn(lsn);
+    }
+}
+
+bool ExtendibleHash::splittable(uint32_t page, const char* entry) const
+{
+    const uint64_t mask = (uint64_t(1) << kMaxDepth) - 1;
+    const uint64_t h    = hashOf(entry) & mask;
+    const size_t   E    = entrySize();
+    auto        g   = gBufPool.fetch(bf_.id(), page, Latch::Shared);
+    const char* raw = g.page().raw();
+    BucketHeader b  = header(raw);
+    if (b.local >= kMaxDepth) return false;
+    for (size_t i = 0; i < b.count; ++i)
+        if ((hashOf(raw + kBucket + i * E) & mask) != h) return true;
+    return false;
+}
+
+void ExtendibleHash::split(uint32_t page, uint16_t local, uint64_t lsn)
+{
+    if (local == depth_) {                             // no spare bit: double the directory
+        const size_t n = dir_.size();
+        dir_.resize(2 * n);
+        std::copy(dir_.begin(), dir_.begin() + n, dir_.begin() + n);
+        ++depth_;
+        writeDir(n, 2 * n, lsn);
+    }
+
+    // both halves of the chain's entries, told apart by hash bit `local`
+    const size_t E = entrySize(), cap = bucketCap();
+    std::vector<uint32_t> chain;
+    std::string stay, move;
+    for (uint32_t q = page; q;) {
+        auto        g   = gBufPool.fetch(bf_.id(), q, Latch::Shared);
+        const char* raw = g.page().raw();
+        BucketHeader b  = header(raw);
+        for (size_t i = 0; i < b.count; ++i) {
+            const char* e = raw + kBucket + i * E;
+            (hashOf(e) >> local & 1 ? move : stay).append(e, E);
+        }
+        chain.push_back(q);
+        q = b.next;
+    }
+
+    // each half is a chain whose head holds the odd entries and the
+    // rest full pages, so only a chain's first two pages ever have room.
+    // `stay` reuses the old chain from its head; pages it no longer
+    // needs start the `move` chain before any new page is allocated
+    auto pagesFor = [&](const std::string& from) {
+        return std::max<size_t>(1, (from.size() / E + cap - 1) / cap);
+    };
+    const size_t keep = pagesFor(stay), want = pagesFor(move);
+    std::vector<uint32_t> moved(chain.begin() + keep, chain.end());
+    chain.resize(keep);
+    moved.resize(std::min(moved.size(), want));        // any beyond are dropped
+    const size_t firstNew = bf_.pageCount();
+    while (moved.size() < want) moved.push_back(static_cast<uint32_t>(bf_.allocatePage()));
+
+    auto fill = [&](const std::vector<uint32_t>& pages, const std::string& from) {
+        const size_t n = from.size() / E;
+        size_t at = 0;
+        for (size_t i = 0; i < pages.size(); ++i) {
+            const size_t c = i == 0 ? n - (pages.size() - 1) * cap : cap;
+            PagePin   pin;
+            PageGuard g;
+            if (pages[i] >= firstNew) {
+                pin = gBufPool.pinNew(bf_.id(), pages[i]);
+                g   = pin.latch(Latch::Exclusive);
+            } else {
+                g = gBufPool.fetch(bf_.id(), pages[i], Latch::Exclusive);
+            }
+            char* raw = g.mutPage().raw();
+            std::memset(raw, 0, PAGE_SIZE);
+            setHeader(raw, c, static_cast<uint16_t>(local + 1), i + 1 < pages.size() ? pages[i + 1] : 0);
+            std::memcpy(raw + kBucket, from.data() + at * E, c * E);
+            at += c;
+            if (lsn) g.setLsn(lsn);
+        }
+    };
+    fill(chain, stay);
+    fill(moved, move);
+
+    size_t lo = dir_.size(), hi = 0;
+    for (size_t i = 0; i < dir_.size(); ++i)
+        if (dir_[i] == page && (i >> local & 1)) {
+            dir_[i] = moved[0];
+            lo = std::min(lo, i);
+            hi = i + 1;
+        }
+    if (lo < hi) writeDir(lo, hi, lsn);
+}
+
+void ExtendibleHash::insert(const char* key, Rid rid, uint64_t lsn)
+{
+    std::unique_lock lock(mtx_);
+    if (dir_.empty()) throw StorageError("index " + bf_.path().string() + " was never built");
+    char e[BTree::kMaxKey + BTree::kRidBytes];
+    BTree::entry(e, key, width_, rid);
+    add(e, hashOf(key), lsn);
+    ++entries_;
+    writeMeta(lsn);
+}
+
+void ExtendibleHash::insert(const std::vector<const char*>& entries, uint64_t lsn)
+{
+    std::unique_lock lock(mtx_);
+    if (dir_.empty()) throw StorageError("index " + bf_.path().string() + " was never built");
+    if (entries.empty()) return;
+
+    // bucket by bucket, so each one's pages are fetched while still hot
+    std::vector<std::pair<uint64_t, const char*>> hashed(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) hashed[i] = {hashOf(entries[i]), entries[i]};
+    const uint64_t slots = dir_.size() - 1;
+    std::stable_sort(hashed.begin(), hashed.end(),
+                     [slots](const auto& a, const auto& b) { return (a.first & slots) < (b.first & slots); });
+    for (const auto& [h, e] : hashed) add(e, h, lsn);
+    entries_ += entries.size();
+    writeMeta(lsn);
+}
+
+void ExtendibleHash::add(const char* e, uint64_t h, uint64_t lsn)
+{
+    const size_t E = entrySize();
+    // e onto page q if it has room; b: q's header either way
+    auto place = [&](uint32_t q, BucketHeader& b) {
+        auto g = gBufPool.fetch(bf_.id(), q, Latch::Exclusive);
+        b = header(g.page().raw());
+        if (b.count >= bucketCap()) return false;
+        char* raw = g.mutPage().raw();
+        std::memcpy(raw + kBucket + b.count * E, e, E);
+        setHeader(raw, b.count + 1u, b.local, b.next);
+        if (lsn) g.setLsn(lsn);
+        return true;
+    };
+
+    for (;;) {
+        // only the first two pages of a chain can have room (see split())
+        const uint32_t first = dir_[h & (dir_.size() - 1)];
+        BucketHeader   head, second;
+        if (place(first, head)) return;
+        if (head.next && place(head.next, second)) return;
+        if (splittable(first, e)) {                    // full: split and look again
+            split(first, head.local, lsn);
+            continue;
+        }
+        // every key here hashes alike: a new second page for the chain
+        uint32_t ov = static_cast<uint32_t>(bf_.allocatePage());
+        {
+            PagePin pin = gBufPool.pinNew(bf_.id(), ov);
+            auto    g   = pin.latch(Latch::Exclusive);
+            char*   raw = g.mutPage().raw();
+            std::memset(raw, 0, PAGE_SIZE);
+            setHeader(raw, 1, head.local, head.next);
+            std::memcpy(raw + kBucket, e, E);
+            if (lsn) g.setLsn(lsn);
+        }
+        auto g = gBufPool.fetch(bf_.id(), first, Latch::Exclusive);
+        setHeader(g.mutPage().raw(), head.count, head.local, ov);
+        if (lsn) g.setLsn(lsn);
+        return;
+    }
+}
+
+void ExtendibleHash::build(const std::vector<const char*>& entries)
+{
+    constexpr size_t kRun = 64;                        // pages per pwritev, as COPY
+
+    std::unique_lock lock(mtx_);
+    if (entries_ != 0) throw StorageError("index " + bf_.path().string() + " is not empty");
+
+    // enough buckets for ~75% fill, then the entries grouped by bucket
+    const size_t n = entries.size(), cap = bucketCap(), E = entrySize();
+    uint16_t d = 0;
+    while (d < kMaxDepth && (n >> d) > cap * 3 / 4) ++d;
+    const size_t buckets = size_t(1) << d;
+
+    std::vector<uint32_t>    start(buckets + 1, 0), which(n);
+    std::vector<const char*> grouped(n);
+    for (size_t i = 0; i < n; ++i) ++start[(which[i] = hashOf(entries[i]) & (buckets - 1)) + 1];
+    for (size_t b = 0; b < buckets; ++b) start[b + 1] += start[b];
+    {
+        std::vector<uint32_t> at(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < n; ++i) grouped[at[which[i]]++] = entries[i];
+    }
+
+    // page order: primary buckets, overflow pages bucket by bucket, directory
+    const uint32_t first = static_cast<uint32_t>(bf_.pageCount());
+    std::vector<uint32_t> overflow(buckets + 1);       // first overflow page of bucket b
+    overflow[0] = first + static_cast<uint32_t>(buckets);
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t c = start[b + 1] - start[b];
+        overflow[b + 1] = overflow[b] + static_cast<uint32_t>(c > cap ? (c - 1) / cap : 0);
+    }
+
+    std::vector<Page>        run(kRun);
+    std::vector<const char*> bufs;
+    size_t runFirst = first, used = 0;
+    auto writeRun = [&] {
+        bufs.clear();
+        for (size_t i = 0; i < used; ++i) bufs.push_back(run[i].raw());
+        bf_.writeDirect(runFirst, bufs);
+        runFirst += used;
+        used = 0;
+    };
+    auto fresh = [&] {                                 // next page in file order, zeroed
+        if (used == kRun) writeRun();
+        bf_.allocatePage();
+        char* raw = run[used++].raw();
+        std::memset(raw, 0, PAGE_SIZE);
+        return raw;
+    };
+    auto bucketPage = [&](size_t b, size_t k) {        // k-th page of bucket b's chain
+        uint32_t pages = overflow[b + 1] - overflow[b];
+        size_t   odd   = start[b + 1] - start[b] - pages * cap;   // the head's, as split() leaves it
+        size_t   from  = start[b] + (k ? odd + (k - 1) * cap : 0), c = k ? cap : odd;
+        char*    raw   = fresh();
+        setHeader(raw, c, d, k < pages ? overflow[b] + static_cast<uint32_t>(k) : 0);
+        for (size_t i = 0; i < c; ++i) std::memcpy(raw + kBucket + i * E, grouped[from + i], E);
+    };
+    for (size_t b = 0; b < buckets; ++b) bucketPage(b, 0);
+    for (size_t b = 0; b < buckets; ++b)
+        for (size_t k = 1; k <= overflow[b + 1] - overflow[b]; ++k) bucketPage(b, k);
+
+    dir_.resize(buckets);
+    dirPages_.clear();
+    for (size_t b = 0; b < buckets; ++b) dir_[b] = first + static_cast<uint32_t>(b);
+    for (size_t at = 0; at < buckets; at += kDirSlots) {
+        dirPages_.push_back(static_cast<uint32_t>(runFirst + used));
+        std::memcpy(fresh(), dir_.data() + at, std::min(kDirSlots, buckets - at) * sizeof(uint32_t));
+    }
+    writeRun();
+    bf_.sync();                                        // buckets before the meta page names them
+
+    depth_   = d;
+    entries_ = n;
+    writeMeta(0);
+}
+
+void ExtendibleHash::probe(const char* key, std::vector<Rid>& out) const
+{
+    std::shared_lock lock(mtx_);
+    if (dir_.empty()) return;
+    const size_t E = entrySize();
+    for (uint32_t q = dir_[hashOf(key) & (dir_.size() - 1)]; q;) {
+        auto         g   = gBufPool.fetch(bf_.id(), q, Latch::Shared);
+        const char*  raw = g.page().raw();
+        BucketHeader b   = header(raw);
+        for (size_t i = 0; i < b.count; ++i) {
+            const char* e = raw + kBucket + i * E;
+            if (std::memcmp(e, key, width_) == 0) out.push_back(BTree::ridOf(e, width_));
+        }
+        q = b.next;
+    }
+}
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,191 @@
+#include "FileHandle.hpp"
+#include "Page.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace elvoiddb::storage {
+
+HandleCache gHandles;
+
+/* ─── FileHandle ────────────────────────────────────────────── */
+
+FileHandle::FileHandle(const fs::path& p, bool create) : path_(p)
+{
+    int flags = O_RDWR | O_CLOEXEC;
+    if (create) flags |= O_CREAT | O_TRUNC;
+    fd_ = ::open(path_.c_str(), flags, 0644);
+    if (fd_ < 0) throw StorageError("cannot open " + path_.string() + ": " + std::strerror(errno));
+}
+
+FileHandle::~FileHandle()
+{
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void FileHandle::readPage(size_t n, char* buf) const
+{
+    size_t got = 0;
+    while (got < PAGE_SIZE) {
+        ssize_t r = ::pread(fd_, buf + got, PAGE_SIZE - got, n * PAGE_SIZE + got);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) throw StorageError("read fail " + path_.string());
+        if (r == 0) break;                             // past EOF
+        got += r;
+    }
+    if (got < PAGE_SIZE)                               // short read → zero-fill remainder
+        std::memset(buf + got, 0, PAGE_SIZE - got);
+}
+
+void FileHandle::readPages(size_t first, const std::vector<char*>& bufs) const
+{
+    std::vector<iovec> iov(bufs.size());
+    for (size_t i = 0; i < bufs.size(); ++i) iov[i] = iovec{bufs[i], PAGE_SIZE};
+
+    size_t got = 0, total = bufs.size() * PAGE_SIZE, idx = 0;
+    while (got < total) {
+        int cnt = static_cast<int>(std::min<size_t>(iov.size() - idx, IOV_MAX));
+        ssize_t r = ::preadv(fd_, iov.data() + idx, cnt, first * PAGE_SIZE + got);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) throw StorageError("read fail " + path_.string());
+        if (r == 0) break;                             // past EOF
+        got += r;
+        while (idx < iov.size() && size_t(r) >= iov[idx].iov_len) {
+            r -= iov[idx].iov_len;
+            ++idx;
+        }
+        if (idx < iov.size() && r > 0) {
+            iov[idx].iov_base = static_cast<char*>(iov[idx].iov_base) + r;
+            iov[idx].iov_len -= r;
+        }
+    }
+    for (; idx < iov.size(); ++idx)                    // short read → zero-fill remainder
+        std::memset(iov[idx].iov_base, 0, iov[idx].iov_len);
+}
+
+void FileHandle::writePage(size_t n, const char* buf)
+{
+    size_t put = 0;
+    while (put < PAGE_SIZE) {
+        ssize_t r = ::pwrite(fd_, buf + put, PAGE_SIZE - put, n * PAGE_SIZE + put);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) throw StorageError("write fail " + path_.string());
+        put += r;
+    }
+}
+
+void FileHandle::writePages(size_t first, const std::vector<const char*>& bufs)
+{
+    std::vector<iovec> iov(bufs.size());
+    for (size_t i = 0; i < bufs.size(); ++i)
+        iov[i] = iovec{const_cast<char*>(bufs[i]), PAGE_SIZE};
+
+    size_t done = 0, total = bufs.size() * PAGE_SIZE, idx = 0;
+    while (done < total) {
+        int cnt = static_cast<int>(std::min<size_t>(iov.size() - idx, IOV_MAX));
+        ssize_t r = ::pwritev(fd_, iov.data() + idx, cnt, first * PAGE_SIZE + done);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) throw StorageError("write fail " + path_.string());
+        done += r;
+        while (idx < iov.size() && size_t(r) >= iov[idx].iov_len) {   // skip finished
+            r -= iov[idx].iov_len;
+            ++idx;
+        }
+        if (idx < iov.size() && r > 0) {                               // partial iovec
+            iov[idx].iov_base = static_cast<char*>(iov[idx].iov_base) + r;
+            iov[idx].iov_len -= r;
+        }
+    }
+}
+
+size_t FileHandle::pageCount() const
+{
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) throw StorageError("stat fail " + path_.string());
+    return static_cast<size_t>(st.st_size) / PAGE_SIZE;
+}
+
+void FileHandle::truncate(size_t pages)
+{
+    if (::ftruncate(fd_, static_cast<off_t>(pages * PAGE_SIZE)) != 0) throw StorageError("truncate fail " + path_.string());
+}
+
+void FileHandle::sync()
+{
+    if (::fdatasync(fd_) != 0) throw StorageError("sync fail " + path_.string());
+}
+
+/* ─── MappedFile ────────────────────────────────────────────── */
+
+MappedFile::MappedFile(const FileHandle& fh) : pages_(fh.pageCount())
+{
+    if (pages_ == 0) return;                           // mmap rejects length 0
+    void* p = ::mmap(nullptr, pages_ * PAGE_SIZE, PROT_READ, MAP_SHARED, fh.fd(), 0);
+    if (p == MAP_FAILED)
+        throw StorageError("cannot map " + fh.path().string() + ": " + std::strerror(errno));
+    base_ = static_cast<const char*>(p);
+}
+
+MappedFile::~MappedFile()
+{
+    if (base_) ::munmap(const_cast<char*>(base_), pages_ * PAGE_SIZE);
+}
+
+void MappedFile::adviseSequential() const
+{
+    if (base_) ::madvise(const_cast<char*>(base_), pages_ * PAGE_SIZE, MADV_SEQUENTIAL);
+}
+
+void MappedFile::adviseRandom() const
+{
+    if (base_) ::madvise(const_cast<char*>(base_), pages_ * PAGE_SIZE, MADV_RANDOM);
+}
+
+/* ─── HandleCache ───────────────────────────────────────────── */
+
+FileId HandleCache::open(const fs::path& p, bool create)
+{
+    std::unique_lock lock(mtx_);
+    if (auto it = ids_.find(p.string()); it != ids_.end() && byId_[it->second]) {
+        if (create) byId_[it->second]->truncate();
+        return it->second;
+    }
+    auto fh = std::make_shared<FileHandle>(p, create);
+    auto id = static_cast<FileId>(byId_.size());
+    byId_.push_back(std::move(fh));
+    ids_[p.string()] = id;
+    return id;
+}
+
+std::shared_ptr<FileHandle> HandleCache::get(FileId id) const
+{
+    std::shared_lock lock(mtx_);
+    if (id >= byId_.size() || !byId_[id]) throw StorageError("file id not open");
+    return byId_[id];
+}
+
+void HandleCache::syncAll() const
+{
+    std::vector<std::shared_ptr<FileHandle>> open;
+    {
+        std::shared_lock lock(mtx_);
+        for (const auto& fh : byId_) if (fh) open.push_back(fh);
+    }
+    for (const auto& fh : open) fh->sync();
+}
+
+void HandleCache::close(FileId id)
+{
+    std::unique_lock lock(mtx_);
+    if (id >= byId_.size() || !byId_[id]) return;
+    ids_.erase(byId_[id]->path().string());
+    byId_[id].reset();
+}
+
+} // namespace elvoiddb::storage
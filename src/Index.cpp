@@ -0,0 +1,249 @@
+#include "Index.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace elvoiddb::storage {
+
+namespace {
+
+void putBig(uint64_t v, char* out)
+{
+    for (int i = 7; i >= 0; --i, v >>= 8) out[i] = static_cast<char>(v & 0xFF);
+}
+
+uint64_t getBig(const char* in)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = v << 8 | static_cast<unsigned char>(in[i]);
+    return v;
+}
+
+constexpr uint64_t kSign = uint64_t(1) << 63;
+
+void encodeInt(int64_t v, char* out) { putBig(static_cast<uint64_t>(v) ^ kSign, out); }
+
+void encodeDouble(double v, char* out)
+{
+    if (v == 0) v = 0;                                 // -0 == 0
+    uint64_t b;
+    std::memcpy(&b, &v, sizeof b);
+    putBig(b & kSign ? ~b : b | kSign, out);
+}
+
+// the key of a key-width string as a number, for estimate()
+double decode(ColType t, const std::string& key)
+{
+    uint64_t b = getBig(key.data());
+    if (t == ColType::Int64) return static_cast<double>(static_cast<int64_t>(b ^ kSign));
+    b = b & kSign ? b & ~kSign : ~b;
+    double v;
+    std::memcpy(&v, &b, sizeof v);
+    return v;
+}
+
+} // namespace
+
+/* ─── Index ─────────────────────────────────────────────────── */
+
+fs::path Index::file(const std::string& table, const std::string& name)
+{
+    return table + "." + name + ".idx";
+}
+
+uint16_t Index::keyWidth(const Column& c)
+{
+    switch (c.type) {
+    case ColType::Int64:
+    case ColType::Double: return 8;
+    case ColType::Bool:   return 1;
+    case ColType::Char:   return std::min(c.width, kTextKey);
+    case ColType::Text:   break;
+    }
+    return kTextKey;
+}
+
+Index::Index(const std::string& table, std::string name, const Schema& s, size_t col,
+             IndexKind kind, bool create)
+    : name_(std::move(name)), col_(col), type_(s[col].type), kind_(kind)
+{
+    if (kind_ == IndexKind::Hash)
+        hash_ = std::make_unique<ExtendibleHash>(file(table, name_), create, keyWidth(s[col]));
+    else
+        tree_ = std::make_unique<BTree>(file(table, name_), create, keyWidth(s[col]));
+    if (width() != keyWidth(s[col]))
+        throw StorageError("index " + name_ + " does not match column " + s[col].name);
+}
+
+bool Index::key(const RowRef& row, char* out) const
+{
+    if (row.isNull(col_)) return false;
+    std::memset(out, 0, width());
+    switch (type_) {
+    case ColType::Int64:  encodeInt(row.getInt(col_), out);       break;
+    case ColType::Double: encodeDouble(row.getDouble(col_), out); break;
+    case ColType::Bool:   out[0] = row.getBool(col_);             break;
+    case ColType::Text:
+    case ColType::Char: {
+        std::string_view t = row.getText(col_);
+        std::memcpy(out, t.data(), std::min<size_t>(t.size(), width()));
+        break;
+    }
+    }
+    return true;
+}
+
+void Index::insert(const RowRef& row, Rid rid, uint64_t lsn)
+{
+    char k[BTree::kMaxKey];
+    if (!key(row, k)) return;
+    if (hash_) hash_->insert(k, rid, lsn);
+    else       tree_->insert(k, rid, lsn);
+}
+
+void Index::add(std::string& batch, const RowRef& row, Rid rid) const
+{
+    char k[BTree::kMaxKey];
+    if (!key(row, k)) return;
+    size_t at = batch.size();
+    batch.resize(at + width() + BTree::kRidBytes);
+    BTree::entry(batch.data() + at, k, width(), rid);
+}
+
+void Index::insertBatch(const std::string& batch, uint64_t lsn)
+{
+    const size_t E = size_t(width()) + BTree::kRidBytes;
+    std::vector<const char*> sorted(batch.size() / E);
+    for (size_t i = 0; i < sorted.size(); ++i) sorted[i] = batch.data() + i * E;
+
+    if (hash_) {                                       // no order to keep
+        if (hash_->size() == 0) {
+            hash_->build(sorted);
+            return;
+        }
+        hash_->insert(sorted, lsn);
+        return;
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [E](const char* a, const char* b) { return std::memcmp(a, b, E) < 0; });
+
+    if (tree_->height() == 0) {                        // first rows: pack the tree bottom-up
+        tree_->build(sorted);
+        return;
+    }
+    for (const char* e : sorted)                       // in key order: neighbouring leaves stay hot
+        tree_->insert(e, BTree::ridOf(e, width()), lsn);
+}
+
+bool Index::range(const std::vector<Predicate::Term>& terms, KeyRange& r) const
+{
+    const uint16_t w = width();
+    auto raise = [&](const std::string& k) { if (r.lo.empty() || k > r.lo) r.lo = k; };
+    auto lower = [&](const std::string& k) { if (r.hi.empty() || k < r.hi) r.hi = k; };
+
+    bool any = false;
+    for (const auto& t : terms) {
+        if (t.col != col_) continue;
+        if (hash_ && (t.prefix || t.op != CmpOp::Eq)) continue;   // a hash has no key order
+        std::string k(w, '\0');
+        if (t.prefix) {                                // LIKE 'p%': p\0… … p\xff…
+            std::memcpy(k.data(), t.text.data(), std::min<size_t>(t.text.size(), w));
+            raise(k);
+            if (t.text.size() < w) std::fill(k.begin() + t.text.size(), k.end(), '\xff');
+            lower(k);
+            any = true;
+            continue;
+        }
+        switch (type_) {
+        case ColType::Int64:  encodeInt(t.i, k.data());    break;
+        case ColType::Double: encodeDouble(t.d, k.data()); break;
+        case ColType::Bool:   k[0] = t.b;                  break;
+        case ColType::Text:
+        case ColType::Char:
+            std::memcpy(k.data(), t.text.data(), std::min<size_t>(t.text.size(), w));
+            break;
+        }
+        // bounds stay inclusive: the rows are checked again after the fetch
+        if (t.op != CmpOp::Lt && t.op != CmpOp::Le) raise(k);
+        if (t.op != CmpOp::Gt && t.op != CmpOp::Ge) lower(k);
+        any = true;
+    }
+    return any;
+}
+
+double Index::estimate(const KeyRange& r) const
+{
+    if ((hash_ ? hash_->size() : tree_->size()) == 0) return 0;
+    if (!r.lo.empty() && !r.hi.empty() && r.lo > r.hi) return 0;
+    if (type_ == ColType::Bool) return r.lo.empty() || r.hi.empty() ? 1 : 0.5;
+    if (!r.lo.empty() && r.lo == r.hi) return 0;       // a point: no statistics say otherwise
+
+    if (type_ == ColType::Text || type_ == ColType::Char)   // no order to interpolate in
+        return r.lo.empty() || r.hi.empty() ? 1 : 0;
+
+    std::string min, max;
+    tree_->bounds(min, max);
+    double a = decode(type_, min), b = decode(type_, max);
+    if (!(b > a)) return 1;
+    double lo = r.lo.empty() ? a : std::max(a, decode(type_, r.lo));
+    double hi = r.hi.empty() ? b : std::min(b, decode(type_, r.hi));
+    return hi < lo ? 0 : (hi - lo) / (b - a);          // keys spread evenly between the bounds
+}
+
+/* ─── IndexScan ─────────────────────────────────────────────── */
+
+std::unique_ptr<IndexScan> IndexScan::plan(TableFile& tf, const Predicate& where)
+{
+    if (tf.indexes().empty()) return nullptr;
+    std::vector<Predicate::Term> terms;
+    where.terms(terms);
+
+    const Index* best = nullptr;
+    KeyRange     range;
+    double       share = kMaxShare;
+    for (const auto& ix : tf.indexes()) {
+        KeyRange r;
+        if (!ix->range(terms, r)) continue;
+        double s = ix->estimate(r);
+        // on a tie a hash index wins: one bucket read, no descent
+        if (s > share || (best && s == share &&
+                          (ix->kind() != IndexKind::Hash || best->kind() == IndexKind::Hash)))
+            continue;
+        best  = ix.get();
+        range = std::move(r);
+        share = s;
+    }
+    return best ? std::make_unique<IndexScan>(tf, *best, range, &where) : nullptr;
+}
+
+IndexScan::IndexScan(TableFile& tf, const Index& index, const KeyRange& r, const Predicate* where)
+    : tf_(tf), index_(index), where_(where)
+{
+    if (index.kind() == IndexKind::BTree)
+        cur_.emplace(index.tree().scan(r.lo, r.hi));
+    else if (!r.lo.empty() && r.lo == r.hi)            // range() gives a hash index only points
+        index.hash().probe(r.lo.data(), rids_);
+}
+
+bool IndexScan::next(RowRef& row)
+{
+    const Schema& s = tf_.schema();
+    Rid rid;
+    auto more = [&] {
+        if (cur_) return cur_->next(rid);
+        if (at_ == rids_.size()) return false;
+        rid = rids_[at_++];
+        return true;
+    };
+    while (more()) {
+        if (!tf_.readRecord(rid, rec_)) continue;     // past the end: the tree outran the table
+        uint16_t len = static_cast<uint16_t>(rec_.size());
+        if (!s.valid(rec_.data(), len)) continue;
+        RowRef r(s, rec_.data(), len);
+        if (where_ && !where_->matches(r)) continue;
+        row = r;
+        return true;
+    }
+    return false;
+}
+
+} // namespace elvoiddb::storage
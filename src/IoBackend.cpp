@@ -0,0 +1,299 @@
+#include "IoBackend.hpp"
+#include "Page.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define ELVOIDDB_HAVE_IO_URING 1
+#endif
+
+namespace elvoiddb::storage {
+
+namespace {
+
+// finish an op the kernel left short (or refused) with plain pread/pwrite
+int completeSync(PageIo &op, size_t done)
+{
+    int fd = op.file->fd();
+    off_t base = static_cast<off_t>(op.pageNo * PAGE_SIZE);
+    while (done < PAGE_SIZE) {
+        ssize_t r = op.write ? ::pwrite(fd, op.buf + done, PAGE_SIZE - done, base + done)
+                             : ::pread (fd, op.buf + done, PAGE_SIZE - done, base + done);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return -errno;
+        if (r == 0) {
+            if (op.write) return -EIO;
+            std::memset(op.buf + done, 0, PAGE_SIZE - done);   // past EOF
+            break;
+        }
+        done += r;
+    }
+    return 0;
+}
+
+/* ─── Posix: inline preadv / pwritev over adjacent pages ────── */
+class PosixIo : public IoBackend {
+public:
+    const char *name() const override { return "posix"; }
+
+    size_t submit(std::vector<PageIo> &ops) override {
+        size_t calls = 0;
+        for (size_t i = 0; i < ops.size();) {
+            size_t j = i + 1;                      // extend the run of adjacent pages
+            while (j < ops.size() && ops[j].file == ops[i].file && ops[j].write == ops[i].write &&
+                   ops[j].pageNo == ops[j - 1].pageNo + 1)
+                ++j;
+            int res = 0;
+            try {
+                if (ops[i].write) {
+                    std::vector<const char *> bufs;
+                    for (size_t k = i; k < j; ++k) bufs.push_back(ops[k].buf);
+                    ops[i].file->writePages(ops[i].pageNo, bufs);
+                } else {
+                    std::vector<char *> bufs;
+                    for (size_t k = i; k < j; ++k) bufs.push_back(ops[k].buf);
+                    ops[i].file->readPages(ops[i].pageNo, bufs);
+                }
+            } catch (const StorageError &) {
+                res = -EIO;
+            }
+            for (size_t k = i; k < j; ++k) ops[k].result = res;
+            ++calls;
+            i = j;
+        }
+        return calls;
+    }
+};
+
+#ifdef ELVOIDDB_HAVE_IO_URING
+
+int sysSetup(unsigned entries, io_uring_params *p)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sysEnter(int fd, unsigned submit, unsigned wait, unsigned flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+}
+
+int sysRegister(int fd, unsigned op, void *arg, unsigned nr)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, op, arg, nr));
+}
+
+/* ─── Uring: one SQE per page, one wait per batch ──────────────
+   Raw syscalls against <linux/io_uring.h>; no liburing needed. The
+   ring is shared by the writer and the read-ahead workers, so a batch
+   holds the ring mutex from first SQE to last CQE. Frame buffers go
+   into a sparse registered-buffer table as frames are created, which
+   turns their I/O into READ_FIXED / WRITE_FIXED.                     */
+class UringIo : public IoBackend {
+    static constexpr unsigned kEntries    = 256;
+    static constexpr unsigned kMaxBuffers = 1u << 14;   // kernel limit for one table
+
+    int           fd_{-1};
+    unsigned      sqEntries_{0};
+    void         *sqMap_{nullptr}, *cqMap_{nullptr};
+    size_t        sqMapLen_{0}, cqMapLen_{0};
+    io_uring_sqe *sqes_{nullptr};
+    size_t        sqesLen_{0};
+    unsigned     *sqHead_, *sqTail_, *sqMask_, *sqArray_;
+    unsigned     *cqHead_, *cqTail_, *cqMask_;
+    io_uring_cqe *cqes_;
+    std::mutex    ringMtx_;
+
+    bool                 fixed_{false};          // sparse buffer table registered
+    std::mutex           regMtx_;
+    std::vector<int32_t> freeSlots_;
+    int32_t              nextSlot_{0};
+
+    void drain(std::vector<PageIo> &ops, size_t first, unsigned n, size_t &calls) {
+        unsigned tail = *sqTail_, mask = *sqMask_;
+        for (unsigned i = 0; i < n; ++i) {
+            PageIo &op = ops[first + i];
+            unsigned idx = tail & mask;
+            io_uring_sqe *sqe = &sqes_[idx];
+            std::memset(sqe, 0, sizeof(*sqe));
+            bool fixed = op.bufIndex >= 0;
+            sqe->opcode = op.write ? (fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE)
+                                   : (fixed ? IORING_OP_READ_FIXED  : IORING_OP_READ);
+            sqe->fd        = op.file->fd();
+            sqe->off       = op.pageNo * PAGE_SIZE;
+            sqe->addr      = reinterpret_cast<uint64_t>(op.buf);
+            sqe->len       = PAGE_SIZE;
+            sqe->buf_index = fixed ? static_cast<uint16_t>(op.bufIndex) : 0;
+            sqe->user_data = first + i;
+            sqArray_[idx]  = idx;
+            ++tail;
+        }
+        __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+
+        unsigned pending = n;
+        while (pending) {
+            int r = sysEnter(fd_, pending, 0, 0);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) throw StorageError(std::string("io_uring_enter: ") + std::strerror(errno));
+            pending -= r;
+            ++calls;
+        }
+
+        unsigned seen = 0;
+        while (seen < n) {
+            unsigned head = *cqHead_;
+            if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                int r = sysEnter(fd_, 0, 1, IORING_ENTER_GETEVENTS);
+                if (r < 0 && errno != EINTR)
+                    throw StorageError(std::string("io_uring_enter: ") + std::strerror(errno));
+                ++calls;
+                continue;
+            }
+            const io_uring_cqe &cqe = cqes_[head & *cqMask_];
+            PageIo &op = ops[cqe.user_data];
+            int res = cqe.res;
+            __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+            ++seen;
+            // short transfer (EOF, signal) or an opcode this kernel lacks
+            if (res < 0)                   op.result = completeSync(op, 0);
+            else if (res < int(PAGE_SIZE)) op.result = completeSync(op, res);
+            else                           op.result = 0;
+        }
+    }
+
+public:
+    UringIo() {
+        io_uring_params p{};
+        fd_ = sysSetup(kEntries, &p);
+        if (fd_ < 0) throw StorageError(std::string("io_uring_setup: ") + std::strerror(errno));
+        sqEntries_ = p.sq_entries;
+
+        sqMapLen_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqMapLen_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqMapLen_ = cqMapLen_ = std::max(sqMapLen_, cqMapLen_);
+        sqMap_ = ::mmap(nullptr, sqMapLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd_, IORING_OFF_SQ_RING);
+        cqMap_ = single ? sqMap_
+                        : ::mmap(nullptr, cqMapLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                 fd_, IORING_OFF_CQ_RING);
+        sqesLen_ = p.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, sqesLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            fd_, IORING_OFF_SQES);
+        if (sqMap_ == MAP_FAILED || cqMap_ == MAP_FAILED || sqes == MAP_FAILED) {
+            if (sqMap_ != MAP_FAILED) ::munmap(sqMap_, sqMapLen_);
+            if (!single && cqMap_ != MAP_FAILED) ::munmap(cqMap_, cqMapLen_);
+            if (sqes != MAP_FAILED) ::munmap(sqes, sqesLen_);
+            ::close(fd_);
+            throw StorageError("io_uring ring mmap failed");
+        }
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        auto *sq = static_cast<char *>(sqMap_);
+        auto *cq = static_cast<char *>(cqMap_);
+        sqHead_  = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        sqTail_  = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sqMask_  = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        cqHead_  = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cqTail_  = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cqMask_  = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes_    = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+
+        // sparse table (5.19+); without it every op uses plain READ / WRITE
+        io_uring_rsrc_register reg{};
+        reg.nr    = kMaxBuffers;
+        reg.flags = IORING_RSRC_REGISTER_SPARSE;
+        fixed_ = sysRegister(fd_, IORING_REGISTER_BUFFERS2, &reg, sizeof(reg)) == 0;
+    }
+
+    ~UringIo() override {
+        ::munmap(sqes_, sqesLen_);
+        if (cqMap_ != sqMap_) ::munmap(cqMap_, cqMapLen_);
+        ::munmap(sqMap_, sqMapLen_);
+        ::close(fd_);
+    }
+
+    const char *name() const override { return "io_uring"; }
+
+    size_t submit(std::vector<PageIo> &ops) override {
+        std::scoped_lock lock(ringMtx_);
+        size_t calls = 0;
+        for (size_t first = 0; first < ops.size(); first += sqEntries_)
+            drain(ops, first, static_cast<unsigned>(std::min<size_t>(sqEntries_, ops.size() - first)),
+                  calls);
+        return calls;
+    }
+
+    int32_t registerBuffer(char *buf) override {
+        if (!fixed_) return -1;
+        std::scoped_lock lock(regMtx_);
+        int32_t slot;
+        if (!freeSlots_.empty())                 slot = freeSlots_.back();
+        else if (nextSlot_ < int32_t(kMaxBuffers)) slot = nextSlot_;
+        else                                     return -1;
+
+        iovec iov{buf, PAGE_SIZE};
+        io_uring_rsrc_update2 up{};
+        up.offset = static_cast<uint32_t>(slot);
+        up.data   = reinterpret_cast<uint64_t>(&iov);
+        up.nr     = 1;
+        if (sysRegister(fd_, IORING_REGISTER_BUFFERS_UPDATE, &up, sizeof(up)) != 1)
+            return -1;                             // e.g. over RLIMIT_MEMLOCK
+        if (!freeSlots_.empty()) freeSlots_.pop_back();
+        else                     ++nextSlot_;
+        return slot;
+    }
+
+    void unregisterBuffer(int32_t slot) override {
+        if (slot < 0) return;
+        std::scoped_lock lock(regMtx_);
+        iovec iov{nullptr, 0};                     // empty entry → slot unregistered
+        io_uring_rsrc_update2 up{};
+        up.offset = static_cast<uint32_t>(slot);
+        up.data   = reinterpret_cast<uint64_t>(&iov);
+        up.nr     = 1;
+        sysRegister(fd_, IORING_REGISTER_BUFFERS_UPDATE, &up, sizeof(up));
+        freeSlots_.push_back(slot);
+    }
+};
+
+#endif // ELVOIDDB_HAVE_IO_URING
+
+} // namespace
+
+std::unique_ptr<IoBackend> makeIoBackend(IoBackendKind want)
+{
+#ifdef ELVOIDDB_HAVE_IO_URING
+    if (want == IoBackendKind::Uring) {
+        try {
+            return std::make_unique<UringIo>();
+        } catch (const StorageError &) {
+            // ENOSYS, io_uring_disabled, seccomp… → thread-side fallback
+        }
+    }
+#else
+    (void)want;
+#endif
+    return std::make_unique<PosixIo>();
+}
+
+IoBackend &ioBackend()
+{
+    static std::unique_ptr<IoBackend> io = [] {
+        const char *env = std::getenv("ELVOIDDB_IO");
+        bool posix = env && std::string(env) == "posix";
+        return makeIoBackend(posix ? IoBackendKind::Posix : IoBackendKind::Uring);
+    }();
+    return *io;
+}
+
+} // namespace elvoiddb::storage
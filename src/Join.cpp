@@ -0,0 +1,418 @@
+#include "Join.hpp"
+#include "Index.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+namespace {
+
+uint64_t mix(uint64_t h)                              // murmur3's fmix64
+{
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 33);
+}
+
+// TEXT and CHAR(n) compare as text
+ColType joinClass(ColType t) { return t == ColType::Char ? ColType::Text : t; }
+
+// the join column's hash; equal values, -0 and 0 too, hash alike
+uint64_t keyHash(const RowRef& row, size_t col, ColType t)
+{
+    switch (t) {
+    case ColType::Int64:  return mix(static_cast<uint64_t>(row.getInt(col)));
+    case ColType::Double: {
+        double   d = row.getDouble(col);
+        uint64_t bits;
+        if (d == 0) d = 0;
+        std::memcpy(&bits, &d, sizeof bits);
+        return mix(bits);
+    }
+    case ColType::Bool:   return mix(row.getBool(col));
+    case ColType::Text:
+    case ColType::Char:   return mix(std::hash<std::string_view>{}(row.getText(col)));
+    }
+    return 0;
+}
+
+bool sameKey(const RowRef& a, size_t ca, const RowRef& b, size_t cb, ColType t)
+{
+    switch (t) {
+    case ColType::Int64:  return a.getInt(ca) == b.getInt(cb);
+    case ColType::Double: return a.getDouble(ca) == b.getDouble(cb);
+    case ColType::Bool:   return a.getBool(ca) == b.getBool(cb);
+    case ColType::Text:
+    case ColType::Char:   return a.getText(ca) == b.getText(cb);
+    }
+    return false;
+}
+
+size_t dataPages(const TableFile& tf)
+{
+    auto& bf = const_cast<TableFile&>(tf).bf();
+    size_t n = bf.mapping() ? bf.mapping()->pageCount() : bf.pageCount();
+    return n ? n - 1 : 0;                              // page 0 is the catalog
+}
+
+// an index on the side's join column; a hash index first, it answers
+// an equality with one bucket read
+const Index* indexOn(const JoinSide& s)
+{
+    const Index* found = nullptr;
+    for (const auto& ix : s.tf.indexes())
+        if (ix->column() == s.col && (!found || ix->kind() == IndexKind::Hash)) found = ix.get();
+    return found;
+}
+
+/* partitioned rows: [u64 hash][u16 length][record] back to back */
+void put(std::string& buf, uint64_t hash, const char* rec, uint16_t len)
+{
+    buf.append(reinterpret_cast<const char*>(&hash), sizeof hash);
+    buf.append(reinterpret_cast<const char*>(&len), sizeof len);
+    buf.append(rec, len);
+}
+
+template <typename F>
+void walk(const std::string& buf, F&& f)
+{
+    for (size_t at = 0; at < buf.size();) {
+        uint64_t hash;
+        uint16_t len;
+        std::memcpy(&hash, buf.data() + at, sizeof hash);
+        std::memcpy(&len, buf.data() + at + sizeof hash, sizeof len);
+        at += sizeof hash + sizeof len;
+        f(hash, buf.data() + at, len);
+        at += len;
+    }
+}
+
+struct Chunk {
+    size_t      morsel;                // the build scan's, for table order
+    std::string rows;
+};
+
+struct Entry {
+    uint64_t    hash;
+    const char* rec;
+    uint16_t    len;
+    uint32_t    next;                  // next entry of the bucket + 1; 0 ends it
+};
+
+struct Partition {
+    std::mutex                 mtx;    // chunks, bytes and the spill files
+    std::vector<Chunk>         chunks;
+    size_t                     bytes{0};
+    std::atomic<bool>          spilled{false};
+    std::unique_ptr<SpillFile> build, probe;
+
+    std::vector<uint32_t>      heads;  // hash & mask → first entry + 1
+    std::vector<Entry>         entries;
+
+    // chained hash table over `chunks`, each bucket in table order
+    void index() {
+        std::sort(chunks.begin(), chunks.end(),
+                  [](const Chunk& a, const Chunk& b) { return a.morsel < b.morsel; });
+        for (const Chunk& c : chunks)
+            walk(c.rows, [&](uint64_t h, const char* rec, uint16_t len) { entries.push_back({h, rec, len, 0}); });
+        size_t n = 1;
+        while (n < entries.size()) n <<= 1;
+        heads.assign(n, 0);
+        for (size_t i = entries.size(); i-- > 0;) {
+            uint32_t& head  = heads[entries[i].hash & (n - 1)];
+            entries[i].next = head;
+            head            = static_cast<uint32_t>(i + 1);
+        }
+    }
+    void release() {
+        std::vector<Chunk>().swap(chunks);
+        std::vector<uint32_t>().swap(heads);
+        std::vector<Entry>().swap(entries);
+    }
+};
+
+} // namespace
+
+/* ─── SpillFile ─────────────────────────────────────────────── */
+
+SpillFile::SpillFile(const fs::path& p) : fh_(p, true)
+{
+    fs::remove(p);                                     // the fd keeps the pages
+}
+
+void SpillFile::append(const std::string& rec)
+{
+    if (page_.insertRecord(rec) >= 0) { open_ = true; return; }
+    fh_.writePage(pages_++, page_.raw());
+    page_ = Page();
+    if (page_.insertRecord(rec) < 0) throw StorageError("row too large to spill");
+}
+
+void SpillFile::forEach(const std::function<void(const char* rec, uint16_t len)>& f)
+{
+    if (open_) {
+        fh_.writePage(pages_++, page_.raw());
+        open_ = false;
+    }
+    std::vector<Page>  run(std::min(kReadPages, pages_));
+    std::vector<char*> bufs;
+    for (size_t first = 0; first < pages_; first += kReadPages) {
+        bufs.clear();
+        for (size_t i = 0; i < std::min(kReadPages, pages_ - first); ++i) bufs.push_back(run[i].raw());
+        fh_.readPages(first, bufs);
+        for (char* pg : bufs) Page::forEachRecord(pg, f);
+    }
+}
+
+/* ─── Join ──────────────────────────────────────────────────── */
+
+size_t Join::defaultBudget()
+{
+    if (const char* env = std::getenv("ELVOIDDB_JOIN_MEMORY")) {
+        char* end;
+        unsigned long long mb = std::strtoull(env, &end, 10);
+        if (*env && !*end) return static_cast<size_t>(mb) << 20;
+    }
+    return size_t(64) << 20;
+}
+
+JoinMethod Join::plan(const JoinSide& left, const JoinSide& right)
+{
+    const double l = static_cast<double>(dataPages(left.tf)), r = static_cast<double>(dataPages(right.tf));
+    if (indexOn(right) && l <= kIndexShare * r) return JoinMethod::IndexRight;
+    if (indexOn(left)  && r <= kIndexShare * l) return JoinMethod::IndexLeft;
+    return JoinMethod::Hash;
+}
+
+Join::Join(JoinSide left, JoinSide right, JoinMethod method, size_t budget, size_t threads)
+    : left_(left), right_(right), method_(method), budget_(budget), threads_(threads)
+{
+    const ColType lt = left.tf.schema()[left.col].type, rt = right.tf.schema()[right.col].type;
+    if (joinClass(lt) != joinClass(rt))
+        throw ExecutionError(std::string("cannot join ") + Schema::typeName(lt) + " with " + Schema::typeName(rt));
+    if ((method == JoinMethod::IndexRight && !indexOn(right)) || (method == JoinMethod::IndexLeft && !indexOn(left)))
+        throw ExecutionError("no index on the inner join column");
+}
+
+void Join::run(const Produce& produce, const Emit& emit)
+{
+    if (method_ == JoinMethod::Hash) hashJoin(produce, emit);
+    else                             indexJoin(produce, emit);
+}
+
+void Join::indexJoin(const Produce& produce, const Emit& emit)
+{
+    const bool      intoRight = method_ == JoinMethod::IndexRight;
+    const JoinSide& outer     = intoRight ? left_ : right_;
+    const JoinSide& inner     = intoRight ? right_ : left_;
+    const Index&    ix        = *indexOn(inner);
+    const ColType   t         = joinClass(outer.tf.schema()[outer.col].type);
+
+    ParallelScan scan(outer.tf, outer.where, threads_);
+    scan.runOrdered(
+        [&](size_t, TableScan& rows, std::string& out) {
+            RowRef row, match;
+            std::vector<Predicate::Term> key(1);
+            while (rows.next(row)) {
+                if (row.isNull(outer.col)) continue;
+                Predicate::Term& k = key[0];
+                k = {inner.col, CmpOp::Eq, false, 0, 0, false, {}};
+                switch (t) {
+                case ColType::Int64:  k.i    = row.getInt(outer.col);    break;
+                case ColType::Double: k.d    = row.getDouble(outer.col); break;
+                case ColType::Bool:   k.b    = row.getBool(outer.col);   break;
+                case ColType::Text:
+                case ColType::Char:   k.text = row.getText(outer.col);   break;
+                }
+                KeyRange r;
+                ix.range(key, r);
+                // TEXT keys are prefixes: the fetched rows are compared whole
+                IndexScan lookup(inner.tf, ix, r, inner.where);
+                while (lookup.next(match)) {
+                    if (!sameKey(row, outer.col, match, inner.col, t)) continue;
+                    if (intoRight) produce(row, match, out);
+                    else           produce(match, row, out);
+                }
+            }
+        },
+        emit);
+}
+
+void Join::hashJoin(const Produce& produce, const Emit& emit)
+{
+    const bool      buildLeft = dataPages(left_.tf) < dataPages(right_.tf);
+    const JoinSide& build     = buildLeft ? left_ : right_;
+    const JoinSide& probe     = buildLeft ? right_ : left_;
+    const ColType   bt        = build.tf.schema()[build.col].type;
+    const ColType   pt        = probe.tf.schema()[probe.col].type;
+    const ColType   t         = joinClass(bt);
+    constexpr int   kShift    = 64 - kRadixBits;
+
+    std::vector<Partition> parts(kPartitions);
+    std::atomic<size_t>    memory{0};
+    auto spillFile = [&](size_t p, const char* side) {
+        return std::make_unique<SpillFile>(build.tf.bf().path().string() + "." + std::to_string(::getpid()) +
+                                           "." + std::to_string(p) + side);
+    };
+    auto spill = [](SpillFile& f, const std::string& rows) {
+        std::string rec;
+        walk(rows, [&](uint64_t, const char* r, uint16_t len) { f.append(rec.assign(r, len)); });
+    };
+    auto matches = [&](const Partition& part, uint64_t h, const RowRef& row, std::string& out) {
+        for (uint32_t i = part.heads[h & (part.heads.size() - 1)]; i; i = part.entries[i - 1].next) {
+            const Entry& e = part.entries[i - 1];
+            if (e.hash != h) continue;
+            RowRef b(build.tf.schema(), e.rec, e.len);
+            if (!sameKey(b, build.col, row, probe.col, t)) continue;
+            if (buildLeft) produce(b, row, out);
+            else           produce(row, b, out);
+        }
+    };
+
+    // 1. partition the build side: each morsel's rows are handed over
+    //    per partition, in memory while the budget lasts
+    ParallelScan buildScan(build.tf, build.where, threads_);
+    std::vector<std::vector<std::string>> local(buildScan.threads(), std::vector<std::string>(kPartitions));
+    buildScan.run([&](size_t worker, size_t morsel, TableScan& rows) {
+        auto&  bufs = local[worker];
+        RowRef row;
+        while (rows.next(row)) {
+            if (row.isNull(build.col)) continue;
+            const uint64_t h = keyHash(row, build.col, bt);
+            put(bufs[h >> kShift], h, row.data(), row.length());
+        }
+        for (size_t p = 0; p < kPartitions; ++p) {
+            if (bufs[p].empty()) continue;
+            Partition&       part = parts[p];
+            std::scoped_lock lock(part.mtx);
+            if (part.spilled) {
+                spill(*part.build, bufs[p]);
+                bufs[p].clear();
+                continue;
+            }
+            const size_t n = bufs[p].size();
+            part.bytes += n;
+            part.chunks.push_back({morsel, std::move(bufs[p])});
+            bufs[p] = std::string();
+            if (memory.fetch_add(n) + n <= budget_) continue;
+            part.build = spillFile(p, ".build");       // over budget: this partition goes to disk
+            for (const Chunk& c : part.chunks) spill(*part.build, c.rows);
+            memory -= part.bytes;
+            std::vector<Chunk>().swap(part.chunks);
+            part.spilled = true;
+        }
+    });
+
+    // 2. a hash table per partition still in memory
+    util::gThreadPool.parallel_for(0, kPartitions, 1, [&](size_t lo, size_t hi) {
+        for (size_t p = lo; p < hi; ++p)
+            if (!parts[p].spilled) parts[p].index();
+    });
+
+    // 3. probe, in table order; rows of spilled partitions go to disk too
+    ParallelScan probeScan(probe.tf, probe.where, threads_);
+    std::vector<std::vector<std::string>> held(probeScan.threads(), std::vector<std::string>(kPartitions));
+    probeScan.runOrdered(
+        [&](size_t worker, TableScan& rows, std::string& out) {
+            auto&  bufs = held[worker];
+            RowRef row;
+            while (rows.next(row)) {
+                if (row.isNull(probe.col)) continue;
+                const uint64_t h    = keyHash(row, probe.col, pt);
+                Partition&     part = parts[h >> kShift];
+                if (part.spilled) put(bufs[h >> kShift], h, row.data(), row.length());
+                else              matches(part, h, row, out);
+            }
+            for (size_t p = 0; p < kPartitions; ++p) {
+                if (bufs[p].empty()) continue;
+                std::scoped_lock lock(parts[p].mtx);
+                if (!parts[p].probe) parts[p].probe = spillFile(p, ".probe");
+                spill(*parts[p].probe, bufs[p]);
+                bufs[p].clear();
+            }
+        },
+        emit);
+    for (Partition& part : parts)
+        if (!part.spilled) part.release();
+
+    // 4. the spilled partitions, one pair of files at a time per thread,
+    //    emitted in partition order. Only the thread on the first
+    //    partition not yet emitted hands output to emit; the others
+    //    hold up to one chunk and wait for their turn.
+    std::vector<size_t> todo;
+    for (size_t p = 0; p < kPartitions; ++p) {
+        spilled_ += parts[p].spilled;
+        if (parts[p].spilled && parts[p].probe) todo.push_back(p);
+    }
+    size_t                  next = 0, head = 0;       // head: first not yet emitted
+    bool                    stop = false;
+    std::mutex              mtx;
+    std::condition_variable turn;                      // head moved on, or stop
+
+    // partition k's output so far, once every partition before it is out;
+    // after a failure elsewhere it is dropped
+    auto flush = [&](size_t k, std::string& buf) {
+        {
+            std::unique_lock lock(mtx);
+            turn.wait(lock, [&] { return stop || head == k; });
+            if (stop) { buf.clear(); return; }
+        }
+        if (!buf.empty()) emit(buf);
+        buf.clear();
+    };
+    auto loop = [&] {
+        for (;;) {
+            size_t k;
+            {
+                std::scoped_lock lock(mtx);
+                if (stop || next >= todo.size()) return;
+                k = next++;
+            }
+            try {
+                Partition&  part = parts[todo[k]];
+                std::string rows, buf;
+                part.build->forEach([&](const char* rec, uint16_t len) {
+                    put(rows, keyHash(RowRef(build.tf.schema(), rec, len), build.col, bt), rec, len);
+                });
+                part.chunks.push_back({0, std::move(rows)});
+                part.index();
+                part.probe->forEach([&](const char* rec, uint16_t len) {
+                    RowRef row(probe.tf.schema(), rec, len);
+                    matches(part, keyHash(row, probe.col, pt), row, buf);
+                    if (buf.size() >= kSpillOutput) flush(k, buf);
+                });
+                part.release();
+                flush(k, buf);
+            } catch (...) {
+                std::scoped_lock lock(mtx);
+                stop = true;                           // nobody starts or waits any more
+                turn.notify_all();
+                throw;
+            }
+            std::scoped_lock lock(mtx);
+            head = k + 1;
+            turn.notify_all();
+        }
+    };
+
+    // claimed in order, so the head partition always has a running thread
+    const size_t threads = std::min(threads_ ? threads_ : std::max<size_t>(util::gThreadPool.size(), 1),
+                                    todo.size());
+    util::TaskGroup group;
+    for (size_t w = 1; w < threads; ++w) group.run(loop);
+    std::exception_ptr error;
+    try { loop(); } catch (...) { error = std::current_exception(); }
+    group.wait();
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace elvoiddb::storage
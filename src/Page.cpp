@@ -14,12 +14,12 @@ int Page::insertRecord(const std::string& bytes)
 {
     auto* h = reinterpret_cast<PageHeader*>(data);
 
-    uint16_t slotArrayEnd   = sizeof(PageHeader) + h->slotCount * sizeof(uint16_t);
-    uint16_t freeStart      = h->freeOffset;
-    uint16_t freeEnd        = PAGE_SIZE - slotArrayEnd;      // record area grows downward
-    uint16_t need           = bytes.size() + sizeof(uint16_t);
+    // slot directory lives at the end of the page and grows downward
+    size_t slotDirStart = PAGE_SIZE - (h->slotCount + 1) * sizeof(uint16_t);
+    size_t freeStart    = h->freeOffset;
+    size_t need         = bytes.size() + sizeof(uint16_t);
 
-    if (freeStart + need > freeEnd) return -1;               // not enough space
+    if (freeStart + need > slotDirStart) return -1;          // not enough space
 
     // write len + payload
     auto* lenPtr = reinterpret_cast<uint16_t*>(data + freeStart);
@@ -27,9 +27,8 @@ int Page::insertRecord(const std::string& bytes)
     std::memcpy(data + freeStart + sizeof(uint16_t), bytes.data(), bytes.size());
 
     // slot entry
-    auto* slotPtr =
-        reinterpret_cast<uint16_t*>(data + sizeof(PageHeader) + h->slotCount * sizeof(uint16_t));
-    *slotPtr = freeStart;
+    auto* slotPtr = reinterpret_cast<uint16_t*>(data + slotDirStart);
+    *slotPtr = static_cast<uint16_t>(freeStart);
 
     h->slotCount += 1;
     h->freeOffset += need;
@@ -38,16 +37,32 @@ int Page::insertRecord(const std::string& bytes)
 
 void Page::forEachRecord(const std::function<void(const char*,uint16_t)>& cb) const
 {
-    const auto* h = reinterpret_cast<const PageHeader*>(data);
-    for (uint16_t i = 0; i < h->slotCount; ++i) {
-        auto* slotPtr = reinterpret_cast<const uint16_t*>(
-            data + sizeof(PageHeader) + i * sizeof(uint16_t));
-        uint16_t offset = *slotPtr;
-        auto* lenPtr = reinterpret_cast<const uint16_t*>(data + offset);
-        uint16_t len = *lenPtr;
-        const char* payload = data + offset + sizeof(uint16_t);
+    forEachRecord(data, cb);
+}
+
+void Page::forEachRecord(const char* data, const std::function<void(const char*,uint16_t)>& cb)
+{
+    uint16_t n = recordCount(data);
+    for (uint16_t i = 0; i < n; ++i) {
+        uint16_t len;
+        const char* payload = record(data, i, len);
         cb(payload, len);
     }
 }
 
+uint16_t Page::recordCount(const char* data)
+{
+    return reinterpret_cast<const PageHeader*>(data)->slotCount;
+}
+
+const char* Page::record(const char* data, uint16_t i, uint16_t& len)
+{
+    auto* slotPtr = reinterpret_cast<const uint16_t*>(
+        data + PAGE_SIZE - (i + 1) * sizeof(uint16_t));
+    uint16_t offset = *slotPtr;
+    auto* lenPtr = reinterpret_cast<const uint16_t*>(data + offset);
+    len = *lenPtr;
+    return data + offset + sizeof(uint16_t);
+}
+
 } // namespace elvoiddb::storage
@@ -0,0 +1,107 @@
+#include "ParallelScan.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+ParallelScan::ParallelScan(TableFile& tf, const Predicate* where, size_t threads)
+    : tf_(tf), where_(where),
+      pages_(tf.bf().mapping() ? tf.bf().mapping()->pageCount() : tf.bf().pageCount()),
+      threads_(threads ? threads : std::max<size_t>(util::gThreadPool.size(), 1))
+{
+    threads_ = std::max<size_t>(1, std::min(threads_, morsels()));
+}
+
+void ParallelScan::drive(const std::function<size_t()>& claim, const std::function<void()>& cancel,
+                         const Body& body)
+{
+    const size_t n = morsels();
+    auto loop = [&](size_t worker) {
+        for (size_t k; (k = claim()) < n;) {
+            const size_t first = 1 + k * kMorselPages;
+            try {
+                TableScan scan(tf_, where_, first, first + kMorselPages);
+                body(worker, k, scan);
+            } catch (...) {
+                cancel();                              // nobody starts another morsel
+                throw;
+            }
+        }
+    };
+
+    // helpers first, so they are drawing while this thread scans too
+    util::TaskGroup group;
+    for (size_t w = 1; w < threads_; ++w) group.run([&loop, w] { loop(w); });
+    std::exception_ptr error;
+    try { loop(0); } catch (...) { error = std::current_exception(); }
+    group.wait();
+    if (error) std::rethrow_exception(error);
+}
+
+void ParallelScan::run(const Body& body)
+{
+    const size_t        n = morsels();
+    std::atomic<size_t> next{0};
+    drive([&] { return std::min(next.fetch_add(1), n); }, [&] { next = n; }, body);
+}
+
+void ParallelScan::runOrdered(const Produce& produce, const Emit& emit)
+{
+    const size_t             n     = morsels();
+    const size_t             ahead = kAhead * threads_;
+    std::vector<std::string> out(n);
+    std::vector<char>        done(n, 0);
+    size_t                   next = 0, ready = 0, emitted = 0;   // ready: done prefix
+    bool                     emitting = false, stop = false;
+    std::mutex               mtx;
+    std::condition_variable  room;                     // emitted moved on
+
+    // a morsel more than `ahead` past the first one not yet emitted waits
+    // for it, so a slow early morsel cannot make the rest pile up
+    auto claim = [&] {
+        std::unique_lock lock(mtx);
+        room.wait(lock, [&] { return stop || next >= n || next < emitted + ahead; });
+        return stop ? n : std::min(next++, n);
+    };
+    auto cancel = [&] {
+        std::scoped_lock lock(mtx);
+        stop = true;
+        room.notify_all();
+    };
+
+    drive(claim, cancel, [&](size_t worker, size_t morsel, TableScan& scan) {
+        std::string buf;
+        produce(worker, scan, buf);
+        std::unique_lock lock(mtx);
+        out[morsel]  = std::move(buf);
+        done[morsel] = 1;
+        // one thread emits at a time, without the lock: it takes the
+        // finished prefix, writes it, and looks again for what other
+        // threads finished meanwhile
+        if (emitting) return;
+        emitting = true;
+        while (ready < n && done[ready]) {
+            std::vector<std::string> batch;
+            for (; ready < n && done[ready]; ++ready) batch.push_back(std::move(out[ready]));
+            lock.unlock();
+            try {
+                for (const auto& b : batch) emit(b);
+            } catch (...) {
+                lock.lock();
+                emitting = false;
+                throw;
+            }
+            lock.lock();
+            emitted = ready;
+            room.notify_all();
+        }
+        emitting = false;
+    });
+}
+
+} // namespace elvoiddb::storage
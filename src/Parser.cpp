@@ -2,6 +2,7 @@
 #include <sstream>
 #include <algorithm>
 #include <cctype>        //  isspace
+#include <cstring>
 
 namespace elvoiddb {
 
@@ -14,6 +15,277 @@ static void stripSemicolon(std::string& s)
         s.pop_back();
 }
 
+/* ── helper: "( a, 'b,c', CHAR(8) )" → trimmed items ──────────
+   s[open] is '('; commas and ')' inside quotes or nested parens do not
+   count. `close` is set to the matching ')'.                          */
+static std::vector<std::string> splitList(const std::string& s, size_t open, size_t& close)
+{
+    std::vector<std::string> items;
+    std::string cur;
+    int  depth  = 0;
+    bool quoted = false;
+    auto push = [&] {
+        size_t b = cur.find_first_not_of(" \t"), e = cur.find_last_not_of(" \t");
+        items.push_back(b == std::string::npos ? "" : cur.substr(b, e - b + 1));
+        cur.clear();
+    };
+    for (size_t i = open + 1; i < s.size(); ++i) {
+        char c = s[i];
+        if (c == '\'') quoted = !quoted;             // '' toggles twice: stays inside
+        else if (!quoted && c == '(') ++depth;
+        else if (!quoted && c == ')' && depth-- == 0) {
+            if (!items.empty() || cur.find_first_not_of(" \t") != std::string::npos) push();
+            close = i;
+            return items;
+        }
+        else if (!quoted && c == ',' && depth == 0) { push(); continue; }
+        cur += c;
+    }
+    throw ParseError("missing )");
+}
+
+/* ── helper: position of keyword `word` in s (any case, a whole
+   word, not inside quotes) at or after `from`; npos if absent ──── */
+static size_t findWord(const std::string& s, size_t from, const char* word)
+{
+    const size_t n    = std::strlen(word);
+    auto         part = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+    bool quoted = false;
+    for (size_t i = from; i < s.size(); ++i) {
+        if (s[i] == '\'') { quoted = !quoted; continue; }
+        if (quoted || (i > 0 && part(s[i - 1])) || i + n > s.size()) continue;
+        size_t k = 0;
+        while (k < n && std::toupper(static_cast<unsigned char>(s[i + k])) == word[k]) ++k;
+        if (k == n && (i + n == s.size() || !part(s[i + n]))) return i;
+    }
+    return std::string::npos;
+}
+
+/* ── helper: "a, COUNT(*), SUM(b)" → SELECT items; "*" → none ── */
+static std::vector<SelectItem> selectList(const std::string& text)
+{
+    std::string wrapped = "(" + text + ")";
+    size_t      close;
+    auto        parts = splitList(wrapped, 0, close);
+    if (close + 1 != wrapped.size()) throw ParseError("unbalanced ) in SELECT list");
+    if (parts.size() == 1 && parts[0] == "*") return {};
+
+    std::vector<SelectItem> items;
+    for (auto& part : parts) {
+        if (part.empty()) throw ParseError("empty item in SELECT list");
+        if (part == "*") throw ParseError("* cannot be listed with other columns");
+        size_t open = part.find('(');
+        if (open == std::string::npos) {
+            items.push_back({part});
+            continue;
+        }
+        std::string fn = part.substr(0, open);
+        fn.erase(fn.find_last_not_of(" \t") + 1);
+        std::transform(fn.begin(), fn.end(), fn.begin(), ::toupper);
+        if (part.back() != ')') throw ParseError("expected ) after " + fn + " argument");
+        std::string arg = part.substr(open + 1, part.size() - open - 2);
+        size_t b = arg.find_first_not_of(" \t"), e = arg.find_last_not_of(" \t");
+        arg = b == std::string::npos ? "" : arg.substr(b, e - b + 1);
+
+        SelectItem item{arg, true};
+        if      (fn == "COUNT") item.fn = storage::AggFn::Count;
+        else if (fn == "SUM")   item.fn = storage::AggFn::Sum;
+        else if (fn == "MIN")   item.fn = storage::AggFn::Min;
+        else if (fn == "MAX")   item.fn = storage::AggFn::Max;
+        else if (fn == "AVG")   item.fn = storage::AggFn::Avg;
+        else throw ParseError("unknown function " + fn);
+        if (arg.empty() || arg.find_first_of(" \t(),") != std::string::npos)
+            throw ParseError(fn + " takes one column");
+        if (arg == "*" && item.fn != storage::AggFn::Count) throw ParseError(fn + "(*) is not allowed");
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+/* ── helper: WHERE condition → Predicate ──────────────────────
+     or   := and { OR and }
+     and  := term { AND term }
+     term := ( or ) | col op literal | col IS [NOT] NULL
+           | col LIKE 'text[%]'
+   op is = != <> < <= > >=; a literal is a number, 'text', TRUE,
+   FALSE or NULL. `literal op col` is accepted and flipped. LIKE takes
+   a prefix pattern only ('ab%'); without the % it is plain =.       */
+namespace {
+
+class CondParser {
+    enum class Tok { End, Word, Number, String, Op, LParen, RParen };
+    const std::string& s_;
+    size_t      pos_{0};
+    Tok         tok_{Tok::End};
+    std::string text_;
+
+    static std::string up(std::string w) {
+        std::transform(w.begin(), w.end(), w.begin(), ::toupper);
+        return w;
+    }
+
+    void advance() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+        text_.clear();
+        if (pos_ == s_.size()) { tok_ = Tok::End; return; }
+        char c = s_[pos_];
+        if (c == '(') { ++pos_; tok_ = Tok::LParen; return; }
+        if (c == ')') { ++pos_; tok_ = Tok::RParen; return; }
+        if (c == '\'') {                                // 'it''s'
+            for (++pos_;; ++pos_) {
+                if (pos_ == s_.size()) throw ParseError("unterminated string in WHERE");
+                if (s_[pos_] == '\'') {
+                    if (pos_ + 1 < s_.size() && s_[pos_ + 1] == '\'') { text_ += '\''; ++pos_; continue; }
+                    ++pos_;
+                    break;
+                }
+                text_ += s_[pos_];
+            }
+            tok_ = Tok::String;
+            return;
+        }
+        if (std::strchr("=!<>", c)) {
+            std::string two = s_.substr(pos_, 2);
+            text_ = two == "!=" || two == "<>" || two == "<=" || two == ">=" ? two : std::string(1, c);
+            pos_ += text_.size();
+            tok_  = Tok::Op;
+            return;
+        }
+        bool num = std::isdigit(static_cast<unsigned char>(c)) || c == '.' ||
+                   ((c == '-' || c == '+') && pos_ + 1 < s_.size() &&
+                    (std::isdigit(static_cast<unsigned char>(s_[pos_ + 1])) || s_[pos_ + 1] == '.'));
+        if (num) {
+            text_ += s_[pos_++];
+            while (pos_ < s_.size() && (std::isalnum(static_cast<unsigned char>(s_[pos_])) ||
+                                        s_[pos_] == '.' ||
+                                        ((s_[pos_] == '-' || s_[pos_] == '+') &&
+                                         (s_[pos_ - 1] == 'e' || s_[pos_ - 1] == 'E'))))
+                text_ += s_[pos_++];
+            tok_ = Tok::Number;
+            return;
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            auto word = [&](size_t i) {
+                return i < s_.size() && (std::isalnum(static_cast<unsigned char>(s_[i])) || s_[i] == '_');
+            };
+            while (word(pos_) || (s_[pos_] == '.' && word(pos_ + 1) && !text_.empty()))   // t.col
+                text_ += s_[pos_++];
+            tok_ = Tok::Word;
+            return;
+        }
+        throw ParseError(std::string("unexpected '") + c + "' in WHERE");
+    }
+
+    bool keyword(const char* kw) const { return tok_ == Tok::Word && up(text_) == kw; }
+
+    storage::CmpOp op() const {
+        using storage::CmpOp;
+        if (text_ == "=")                   return CmpOp::Eq;
+        if (text_ == "!=" || text_ == "<>") return CmpOp::Ne;
+        if (text_ == "<")                   return CmpOp::Lt;
+        if (text_ == "<=")                  return CmpOp::Le;
+        if (text_ == ">")                   return CmpOp::Gt;
+        if (text_ == ">=")                  return CmpOp::Ge;
+        throw ParseError("unknown operator " + text_);
+    }
+
+    static storage::CmpOp flip(storage::CmpOp o) {
+        using storage::CmpOp;
+        switch (o) {
+        case CmpOp::Lt: return CmpOp::Gt;
+        case CmpOp::Le: return CmpOp::Ge;
+        case CmpOp::Gt: return CmpOp::Lt;
+        case CmpOp::Ge: return CmpOp::Le;
+        default:        return o;
+        }
+    }
+
+    // current token as a literal, or false if it is a column name
+    bool literal(storage::Value& v) const {
+        using Kind = storage::Value::Kind;
+        v.text = text_;
+        if (tok_ == Tok::Number) { v.kind = Kind::Number; return true; }
+        if (tok_ == Tok::String) { v.kind = Kind::Text;   return true; }
+        if (keyword("NULL"))     { v.kind = Kind::Null;   return true; }
+        if (keyword("TRUE") || keyword("FALSE")) {
+            v.kind = Kind::Bool;
+            v.b    = keyword("TRUE");
+            return true;
+        }
+        if (tok_ != Tok::Word) throw ParseError("expected column or literal in WHERE");
+        return false;
+    }
+
+    std::unique_ptr<storage::Predicate> term() {
+        if (tok_ == Tok::LParen) {
+            advance();
+            auto p = orExpr();
+            if (tok_ != Tok::RParen) throw ParseError("missing ) in WHERE");
+            advance();
+            return p;
+        }
+        storage::Value lhs;
+        bool lhsLit = literal(lhs);
+        advance();
+
+        if (!lhsLit && keyword("IS")) {
+            advance();
+            bool negate = keyword("NOT");
+            if (negate) advance();
+            if (!keyword("NULL")) throw ParseError("expected NULL after IS");
+            advance();
+            return storage::Predicate::isNull(lhs.text, negate);
+        }
+        if (!lhsLit && keyword("LIKE")) {
+            advance();
+            if (tok_ != Tok::String) throw ParseError("LIKE takes a quoted pattern");
+            std::string pat = text_;
+            advance();
+            bool prefix = !pat.empty() && pat.back() == '%';
+            if (prefix) pat.pop_back();
+            if (pat.find_first_of("%_") != std::string::npos)
+                throw ParseError("LIKE supports only 'prefix%' patterns");
+            if (prefix) return storage::Predicate::prefix(lhs.text, std::move(pat));
+            return storage::Predicate::compare(lhs.text, storage::CmpOp::Eq,
+                                               {storage::Value::Kind::Text, std::move(pat)});
+        }
+        if (tok_ != Tok::Op) throw ParseError("expected comparison in WHERE");
+        storage::CmpOp o = op();
+        advance();
+
+        storage::Value rhs;
+        bool rhsLit = literal(rhs);
+        advance();
+        if (lhsLit == rhsLit) throw ParseError("WHERE compares a column with a literal");
+        if (lhsLit) return storage::Predicate::compare(rhs.text, flip(o), std::move(lhs));
+        return storage::Predicate::compare(lhs.text, o, std::move(rhs));
+    }
+
+    std::unique_ptr<storage::Predicate> andExpr() {
+        auto p = term();
+        while (keyword("AND")) { advance(); p = storage::Predicate::both(std::move(p), term()); }
+        return p;
+    }
+
+    std::unique_ptr<storage::Predicate> orExpr() {
+        auto p = andExpr();
+        while (keyword("OR")) { advance(); p = storage::Predicate::either(std::move(p), andExpr()); }
+        return p;
+    }
+
+public:
+    explicit CondParser(const std::string& s) : s_(s) { advance(); }
+
+    std::unique_ptr<storage::Predicate> parse() {
+        if (tok_ == Tok::End) throw ParseError("empty WHERE");
+        auto p = orExpr();
+        if (tok_ != Tok::End) throw ParseError("unexpected " + text_ + " in WHERE");
+        return p;
+    }
+};
+
+} // namespace
+
 /* ── Parser core ────────────────────────────────────────────── */
 void Parser::upper(std::string& s)
 {
@@ -28,55 +300,178 @@ std::unique_ptr<SQLCommand> Parser::parse(const std::string& line)
 
     std::string tok; ss >> tok; upper(tok);
 
-    /* CREATE TABLE name (col1,col2,…) */
+    /* CREATE TABLE name (col [TYPE], …) [USING ROW|PAX]
+       CREATE INDEX name ON table (col) [USING BTREE|HASH]   */
     if (tok == "CREATE") {
         ss >> tok; upper(tok);
-        if (tok != "TABLE") throw ParseError("expected TABLE after CREATE");
+        if (tok == "INDEX") {
+            std::string name; ss >> name;
+            ss >> tok; upper(tok);
+            if (name.empty() || tok != "ON") throw ParseError("expected CREATE INDEX name ON table (column)");
+
+            size_t from = ss.eof() ? buf.size() : static_cast<size_t>(ss.tellg());
+            size_t open = buf.find('(', from);
+            if (open == std::string::npos) throw ParseError("expected ( after table name");
+            std::string table;
+            std::istringstream(buf.substr(from, open - from)) >> table;
+            if (table.empty()) throw ParseError("expected table name");
+
+            size_t close;
+            auto cols = splitList(buf, open, close);
+            if (cols.size() != 1) throw ParseError("an index covers exactly one column");
+            auto kind = storage::IndexKind::BTree;
+            std::istringstream tail(buf.substr(close + 1));
+            if (tail >> tok) {
+                upper(tok);
+                if (tok != "USING") throw ParseError("unexpected " + tok + " after column");
+                tail >> tok; upper(tok);
+                if      (tok == "HASH") kind = storage::IndexKind::Hash;
+                else if (tok != "BTREE") throw ParseError("USING takes BTREE or HASH");
+                if (tail >> tok) throw ParseError("unexpected " + tok + " after USING");
+            }
+            return std::make_unique<CreateIndexCmd>(name, table, cols[0], kind);
+        }
+        if (tok != "TABLE") throw ParseError("expected TABLE or INDEX after CREATE");
+
+        size_t from = static_cast<size_t>(ss.tellg());
+        size_t open = buf.find('(', from);
+        if (open == std::string::npos) throw ParseError("expected ( after table name");
+        std::string name;
+        std::istringstream(buf.substr(from, open - from)) >> name;
+        if (name.empty()) throw ParseError("expected table name");
 
-        std::string name; ss >> name; char ch; ss >> ch;    // '('
-        std::vector<std::string> cols; std::string col;
+        size_t close;
+        auto cols = splitList(buf, open, close);
+        if (cols.empty()) throw ParseError("table needs at least one column");
 
-        while (std::getline(ss, col, ',')) {
-            col.erase(std::remove_if(col.begin(), col.end(),
-                     [](char c){ return c==' '||c=='('||c==')'; }), col.end());
-            if (!col.empty()) cols.push_back(col);
-            if (col.find(')') != std::string::npos) break;
+        auto layout = storage::PageLayout::Slotted;
+        std::istringstream tail(buf.substr(close + 1));
+        if (tail >> tok) {
+            upper(tok);
+            if (tok != "USING") throw ParseError("unexpected " + tok + " after columns");
+            tail >> tok; upper(tok);
+            if      (tok == "PAX") layout = storage::PageLayout::Pax;
+            else if (tok != "ROW") throw ParseError("USING takes ROW or PAX");
+            if (tail >> tok) throw ParseError("unexpected " + tok + " after USING");
         }
-        return std::make_unique<CreateTableCmd>(name, cols);
+        return std::make_unique<CreateTableCmd>(name, cols, layout);
     }
 
-    /* INSERT INTO name VALUES (…) */
+    /* INSERT INTO name VALUES (…), (…), … */
     if (tok == "INSERT") {
         ss >> tok;                                 // INTO
         std::string name; ss >> name;
-        ss >> tok;                                 // VALUES
-        if (tok.rfind("VALUES",0) != 0) throw ParseError("expected VALUES");
-        char ch;
-        if (tok.size() == 6) {          // "VALUES" exactly → read next char
-            ss >> ch;                   // '('
-        } else {                        // token was "VALUES(..."
-            ch = tok[6];                // first char after "VALUES"
-            tok.erase(0,7);             // keep remainder inside stream buffer
-            ss.putback(' ');            // fake a space so getline sees it
-            for (auto it = tok.rbegin(); it!=tok.rend(); ++it) ss.putback(*it);
+
+        std::string rest = buf.substr(static_cast<size_t>(ss.tellg()));
+        size_t pos = rest.find_first_not_of(" \t");
+        std::string kw = pos == std::string::npos ? "" : rest.substr(pos, 6);
+        upper(kw);
+        if (kw != "VALUES") throw ParseError("expected VALUES");
+        pos += 6;
+
+        std::vector<std::vector<std::string>> rows;
+        while ((pos = rest.find_first_not_of(" \t,", pos)) != std::string::npos) {
+            if (rest[pos] != '(') throw ParseError("expected ( in VALUES");
+            size_t close;
+            rows.push_back(splitList(rest, pos, close));   // literals stay quoted
+            pos = close + 1;
         }
-        std::vector<std::string> vals; std::string val;
+        if (rows.empty()) throw ParseError("expected ( after VALUES");
+        return std::make_unique<InsertCmd>(name, std::move(rows));
+    }
+
+    /* COPY name FROM 'path' [DELIMITER 'c'] [HEADER] */
+    if (tok == "COPY") {
+        std::string name; ss >> name;
+        ss >> tok; upper(tok);
+        if (tok != "FROM") throw ParseError("expected FROM after COPY name");
+
+        // quoted path may hold spaces: take it from the raw text
+        auto open  = buf.find('\'', static_cast<size_t>(ss.tellg()));
+        auto close = open == std::string::npos ? open : buf.find('\'', open + 1);
+        if (close == std::string::npos) throw ParseError("expected 'path' after FROM");
+        std::string path = buf.substr(open + 1, close - open - 1);
+        ss.seekg(close + 1);
 
-        while (std::getline(ss, val, ',')) {
-            val.erase(std::remove_if(val.begin(), val.end(),
-                     [](char c){ return c==' '||c=='('||c==')'; }), val.end());
-            if (!val.empty()) vals.push_back(val);
-            if (val.find(')') != std::string::npos) break;
+        bool tsv    = path.size() >= 4 && path.compare(path.size() - 4, 4, ".tsv") == 0;
+        char delim  = tsv ? '\t' : ',';
+        bool header = false;
+        while (ss >> tok) {
+            upper(tok);
+            if (tok == "HEADER") { header = true; continue; }
+            if (tok != "DELIMITER") throw ParseError("unexpected " + tok + " in COPY");
+            std::string d; ss >> d;
+            if      (d == "'\\t'")                                  delim = '\t';
+            else if (d.size() == 3 && d[0] == '\'' && d[2] == '\'') delim = d[1];
+            else throw ParseError("DELIMITER takes one quoted character");
         }
-        return std::make_unique<InsertCmd>(name, vals);
+        return std::make_unique<CopyCmd>(name, path, delim, header);
     }
 
-    /* SELECT * FROM name */
+    /* SELECT * | item, … FROM name [[INNER] JOIN other ON a = b]
+              [WHERE cond] [GROUP BY col, …]
+       item := col | t.col | COUNT(*) | COUNT|SUM|MIN|MAX|AVG(col)     */
     if (tok == "SELECT") {
-        ss >> tok;                                 // *
-        ss >> tok;                                 // FROM
-        std::string name; ss >> name;
-        return std::make_unique<SelectCmd>(name);
+        size_t start = ss.eof() ? buf.size() : static_cast<size_t>(ss.tellg());
+        size_t from  = findWord(buf, start, "FROM");
+        if (from == std::string::npos) throw ParseError("expected FROM");
+        auto items = selectList(buf.substr(start, from - start));
+
+        std::istringstream rest(buf.substr(from + 4));
+        std::string name; rest >> name;
+        if (name.empty()) throw ParseError("expected table name");
+        std::string tail = rest.eof() ? "" : buf.substr(from + 4 + static_cast<size_t>(rest.tellg()));
+
+        // [INNER] JOIN other ON a.x = b.y
+        std::string other, leftOn, rightOn;
+        size_t join = findWord(tail, 0, "JOIN");
+        auto joined = [&] {                        // nothing but INNER before JOIN
+            std::istringstream lead(tail.substr(0, join));
+            if (!(lead >> tok)) return true;
+            upper(tok);
+            return tok == "INNER" && !(lead >> tok);
+        };
+        if (join != std::string::npos && joined()) {
+            std::istringstream on(tail.substr(join + 4));
+            on >> other >> tok; upper(tok);
+            if (other.empty()) throw ParseError("expected table name after JOIN");
+            if (tok != "ON") throw ParseError("expected ON after JOIN " + other);
+            std::string cond = on.eof() ? "" : tail.substr(join + 4 + static_cast<size_t>(on.tellg()));
+            size_t eq = cond.find('=');
+            if (eq == std::string::npos) throw ParseError("expected a = b after ON");
+            std::istringstream lhs(cond.substr(0, eq)), rhs(cond.substr(eq + 1));
+            if (!(lhs >> leftOn) || lhs >> tok || !(rhs >> rightOn))
+                throw ParseError("expected a = b after ON");
+            tail = rhs.eof() ? "" : cond.substr(eq + 1 + static_cast<size_t>(rhs.tellg()));
+        }
+
+        std::vector<std::string> groupBy;
+        size_t group = findWord(tail, 0, "GROUP");
+        if (group != std::string::npos) {
+            size_t by = findWord(tail, group + 5, "BY");
+            if (by == std::string::npos || tail.find_first_not_of(" \t", group + 5) != by)
+                throw ParseError("expected BY after GROUP");
+            size_t close;
+            std::string list = "(" + tail.substr(by + 2) + ")";
+            groupBy = splitList(list, 0, close);
+            for (const auto& g : groupBy)
+                if (g.empty() || g.find_first_of(" \t()") != std::string::npos)
+                    throw ParseError("GROUP BY takes column names");
+            tail.erase(group);
+        }
+
+        std::unique_ptr<storage::Predicate> where;
+        std::istringstream cond(tail);
+        if (cond >> tok) {
+            upper(tok);
+            if (tok != "WHERE") throw ParseError("unexpected " + tok + " after table name");
+            where = CondParser(tail.substr(static_cast<size_t>(cond.tellg()))).parse();
+        }
+        if (other.empty())
+            return std::make_unique<SelectCmd>(name, std::move(where), std::move(items), std::move(groupBy));
+        if (!groupBy.empty() || std::any_of(items.begin(), items.end(), [](auto& i) { return i.agg; }))
+            throw ParseError("GROUP BY and aggregates over a JOIN are not supported");
+        return std::make_unique<JoinCmd>(name, other, leftOn, rightOn, std::move(where), std::move(items));
     }
 
     /* EXIT / QUIT */
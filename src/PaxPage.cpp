@@ -0,0 +1,139 @@
+#include "PaxPage.hpp"
+
+namespace elvoiddb::storage {
+
+namespace {
+
+constexpr size_t kTextGuess = 8;    // expected bytes per TEXT value when sizing cap
+
+uint16_t cellWidth(const Column& c)
+{
+    switch (c.type) {
+    case ColType::Int64:
+    case ColType::Double: return 8;
+    case ColType::Bool:   return 1;
+    case ColType::Char:   return c.width;
+    case ColType::Text:   return PaxLayout::kTextCell;
+    }
+    return 0;
+}
+
+PaxHeader& hdr(char* page) { return *reinterpret_cast<PaxHeader*>(page); }
+
+} // namespace
+
+PaxLayout::PaxLayout(const Schema& s) : schema_(&s)
+{
+    if (s.legacy() || s.size() == 0) throw StorageError("PAX layout needs typed columns");
+
+    size_t rowBits = 0, texts = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        width_.push_back(cellWidth(s[i]));
+        rowBits += 8 * width_.back() + 1;                // cell + null bit
+        if (s[i].type == ColType::Text) ++texts;
+    }
+    rowBits += 8 * kTextGuess * texts;
+
+    // largest cap whose minipages (+ guessed heap) still fit the page
+    size_t cap = std::min<size_t>(8 * (PAGE_SIZE - sizeof(PaxHeader)) / rowBits, 4096);
+    for (; cap > 0; --cap)
+        if (place(static_cast<uint16_t>(cap)) && fixedEnd_ + cap * kTextGuess * texts <= PAGE_SIZE)
+            break;
+    if (cap == 0) throw StorageError("row too wide for a PAX page");
+}
+
+bool PaxLayout::place(uint16_t cap)
+{
+    nulls_.clear();
+    cells_.clear();
+    size_t off = sizeof(PaxHeader);
+    for (size_t i = 0; i < width_.size(); ++i) {
+        nulls_.push_back(static_cast<uint16_t>(off));
+        off += (cap + 7) / 8;
+        if (width_[i] == 8) off = (off + 7) & ~size_t(7);   // int64_t[] / double[] aligned
+        cells_.push_back(static_cast<uint16_t>(off));
+        off += size_t(cap) * width_[i];
+    }
+    if (off > PAGE_SIZE) return false;
+    cap_      = cap;
+    fixedEnd_ = static_cast<uint16_t>(off);
+    return true;
+}
+
+void PaxLayout::format(char* page) const
+{
+    std::memset(page, 0, PAGE_SIZE);
+    hdr(page) = PaxHeader{kMagic, 0, cap_, static_cast<uint16_t>(PAGE_SIZE)};
+}
+
+int PaxLayout::insert(char* page, const char* rec, uint16_t len) const
+{
+    PaxHeader& h = hdr(page);
+    if (h.rows == h.cap) return -1;
+
+    RowRef row(*schema_, rec, len);
+    if (h.heap < fixedEnd_ + textBytes(rec, len)) return -1;   // heap would meet the minipages
+
+    uint16_t r = h.rows;
+    for (size_t i = 0; i < width_.size(); ++i) {
+        if (row.isNull(i)) {
+            page[nulls_[i] + (r >> 3)] |= static_cast<char>(1 << (r & 7));
+            continue;
+        }
+        char* cell = page + cells_[i] + size_t(r) * width_[i];
+        if ((*schema_)[i].type == ColType::Text) {
+            std::string_view v = row.getText(i);
+            h.heap = static_cast<uint16_t>(h.heap - v.size());
+            std::memcpy(page + h.heap, v.data(), v.size());
+            uint16_t ref[2] = {h.heap, static_cast<uint16_t>(v.size())};
+            std::memcpy(cell, ref, sizeof ref);
+        } else {
+            std::memcpy(cell, rec + schema_->offset(i), width_[i]);   // same bytes as the row slot
+        }
+    }
+    h.rows++;
+    return r;
+}
+
+size_t PaxLayout::textBytes(const char* rec, uint16_t len) const
+{
+    RowRef row(*schema_, rec, len);
+    size_t n = 0;
+    for (size_t i = 0; i < width_.size(); ++i)
+        if ((*schema_)[i].type == ColType::Text && !row.isNull(i)) n += row.getText(i).size();
+    return n;
+}
+
+void PaxLayout::row(const char* page, uint16_t r, std::string& out) const
+{
+    out.assign(schema_->fixedSize(), '\0');
+    for (size_t i = 0; i < width_.size(); ++i) {
+        char* slot = out.data() + schema_->offset(i);
+        bool  null = isNull(page, i, r);
+        if (null) out[i >> 3] = static_cast<char>(out[i >> 3] | (1 << (i & 7)));
+
+        if ((*schema_)[i].type == ColType::Text) {         // end offset, even when null
+            std::string_view v = null ? std::string_view() : text(page, i, r);
+            uint16_t end = static_cast<uint16_t>(out.size() + v.size());
+            std::memcpy(slot, &end, sizeof end);
+            out.append(v.data(), v.size());
+        } else if (!null) {
+            std::memcpy(slot, cell(page, i, r), width_[i]);
+        }
+    }
+}
+
+std::string_view PaxLayout::text(const char* page, size_t col, uint16_t r) const
+{
+    const char* cell = this->cell(page, col, r);
+    if ((*schema_)[col].type == ColType::Char) {
+        std::string_view v(cell, width_[col]);
+        while (!v.empty() && v.back() == ' ') v.remove_suffix(1);
+        return v;
+    }
+    uint16_t ref[2];
+    std::memcpy(ref, cell, sizeof ref);
+    return {page + ref[0], ref[1]};
+}
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,221 @@
+#include "Predicate.hpp"
+#include "Simd.hpp"
+#include "Storage.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace elvoiddb::storage {
+
+namespace {
+
+template <typename T>
+bool parseNumber(std::string_view s, T& out)
+{
+    if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+    auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return !s.empty() && ec == std::errc() && p == s.data() + s.size();
+}
+
+} // namespace
+
+std::unique_ptr<Predicate> Predicate::compare(std::string column, CmpOp op, Value v)
+{
+    std::unique_ptr<Predicate> p(new Predicate(Kind::Cmp));
+    p->column_ = std::move(column);
+    p->op_     = op;
+    p->value_  = std::move(v);
+    return p;
+}
+
+std::unique_ptr<Predicate> Predicate::prefix(std::string column, std::string p)
+{
+    std::unique_ptr<Predicate> pred(new Predicate(Kind::Prefix));
+    pred->column_ = std::move(column);
+    pred->value_  = Value{Value::Kind::Text, std::move(p)};
+    return pred;
+}
+
+std::unique_ptr<Predicate> Predicate::isNull(std::string column, bool negate)
+{
+    std::unique_ptr<Predicate> p(new Predicate(negate ? Kind::NotNull : Kind::IsNull));
+    p->column_ = std::move(column);
+    return p;
+}
+
+std::unique_ptr<Predicate> Predicate::both(std::unique_ptr<Predicate> l, std::unique_ptr<Predicate> r)
+{
+    std::unique_ptr<Predicate> p(new Predicate(Kind::And));
+    p->lhs_ = std::move(l);
+    p->rhs_ = std::move(r);
+    return p;
+}
+
+std::unique_ptr<Predicate> Predicate::either(std::unique_ptr<Predicate> l, std::unique_ptr<Predicate> r)
+{
+    std::unique_ptr<Predicate> p(new Predicate(Kind::Or));
+    p->lhs_ = std::move(l);
+    p->rhs_ = std::move(r);
+    return p;
+}
+
+void Predicate::split(std::unique_ptr<Predicate> p, std::vector<std::unique_ptr<Predicate>>& out)
+{
+    if (p->kind_ != Kind::And) { out.push_back(std::move(p)); return; }
+    split(std::move(p->lhs_), out);
+    split(std::move(p->rhs_), out);
+}
+
+void Predicate::rename(const std::function<std::string(const std::string&)>& f)
+{
+    if (lhs_) { lhs_->rename(f); rhs_->rename(f); return; }
+    column_ = f(column_);
+}
+
+void Predicate::bind(const Schema& s)
+{
+    if (kind_ == Kind::And || kind_ == Kind::Or) {
+        lhs_->bind(s);
+        rhs_->bind(s);
+        return;
+    }
+
+    col_ = s.size();
+    for (size_t i = 0; i < s.size(); ++i)
+        if (s[i].name == column_) { col_ = i; break; }
+    if (col_ == s.size()) throw ExecutionError("no column " + column_);
+    const Column& c = s[col_];
+    textCells_ = c.type == ColType::Text && !s.legacy();
+    if (kind_ == Kind::Prefix) {
+        if (c.type != ColType::Text && c.type != ColType::Char)
+            throw ExecutionError("column " + c.name + ": LIKE needs TEXT or CHAR");
+        eval_ = Eval::Text;
+        return;
+    }
+    if (kind_ != Kind::Cmp) return;
+
+    auto bad = [&] {
+        return ExecutionError("column " + c.name + ": '" + value_.text + "' is not " +
+                              Schema::typeName(c.type));
+    };
+    if (value_.kind == Value::Kind::Null) { eval_ = Eval::Never; return; }   // = NULL is never true
+
+    switch (c.type) {
+    case ColType::Int64:
+        if (value_.kind != Value::Kind::Number) throw bad();
+        if (parseNumber(value_.text, int_))      eval_ = Eval::Int;
+        else if (parseNumber(value_.text, dbl_)) eval_ = Eval::IntAsDouble;
+        else throw bad();
+        break;
+    case ColType::Double:
+        if (value_.kind != Value::Kind::Number || !parseNumber(value_.text, dbl_)) throw bad();
+        eval_ = Eval::Double;
+        break;
+    case ColType::Bool:
+        if (value_.kind == Value::Kind::Number && (value_.text == "0" || value_.text == "1"))
+            value_.b = value_.text == "1";
+        else if (value_.kind != Value::Kind::Bool) throw bad();
+        eval_ = Eval::Bool;
+        break;
+    case ColType::Text:
+    case ColType::Char:                                // legacy tables: every column
+        if (value_.kind == Value::Kind::Bool) value_.text = value_.b ? "true" : "false";
+        eval_ = Eval::Text;
+        break;
+    }
+}
+
+void Predicate::columns(std::vector<size_t>& out) const
+{
+    if (lhs_) lhs_->columns(out);
+    if (rhs_) rhs_->columns(out);
+    if (!lhs_ && std::find(out.begin(), out.end(), col_) == out.end()) out.push_back(col_);
+}
+
+void Predicate::terms(std::vector<Term>& out) const
+{
+    if (kind_ == Kind::And) {                          // OR / NULL tests: no single range
+        lhs_->terms(out);
+        rhs_->terms(out);
+        return;
+    }
+    if (kind_ == Kind::Prefix) {
+        out.push_back({col_, CmpOp::Ge, true, 0, 0, false, value_.text});
+        return;
+    }
+    if (kind_ != Kind::Cmp || op_ == CmpOp::Ne || eval_ == Eval::Never) return;
+
+    Term t{col_, op_, false, int_, dbl_, value_.b, value_.text};
+    if (eval_ == Eval::IntAsDouble) {                  // id < 2.5 → id <= 2, id > 2.5 → id >= 3
+        double r = op_ == CmpOp::Lt || op_ == CmpOp::Le ? std::floor(dbl_)
+                 : op_ == CmpOp::Gt || op_ == CmpOp::Ge ? std::ceil(dbl_) : dbl_;
+        if (r != dbl_ && op_ == CmpOp::Eq) return;     // matches nothing; leave it to the scan
+        if (!(r >= -9.2e18 && r <= 9.2e18)) return;    // outside int64: no useful bound
+        t.i  = static_cast<int64_t>(r);
+        t.op = op_ == CmpOp::Lt ? CmpOp::Le : op_ == CmpOp::Gt ? CmpOp::Ge : op_;
+    }
+    out.push_back(t);
+}
+
+void Predicate::matchBatch(const ColumnScan& b, uint64_t* mask) const
+{
+    const size_t n     = b.rows();
+    const size_t words = simd::maskWords(n);
+
+    switch (kind_) {
+    case Kind::And:
+    case Kind::Or: {
+        uint64_t other[simd::maskWords(ColumnScan::kMaxRows)];
+        lhs_->matchBatch(b, mask);
+        rhs_->matchBatch(b, other);
+        for (size_t w = 0; w < words; ++w)
+            mask[w] = kind_ == Kind::And ? mask[w] & other[w] : mask[w] | other[w];
+        return;
+    }
+    case Kind::IsNull:
+    case Kind::NotNull: {
+        std::memset(mask, 0, words * sizeof *mask);
+        std::memcpy(mask, b.nulls(b.slot(col_)), (n + 7) / 8);
+        if (kind_ == Kind::NotNull) {
+            for (size_t w = 0; w < words; ++w) mask[w] = ~mask[w];
+            if (n % 64) mask[words - 1] &= (uint64_t(1) << (n % 64)) - 1;
+        }
+        return;
+    }
+    case Kind::Cmp:
+    case Kind::Prefix:
+        break;
+    }
+
+    const int k = b.slot(col_);
+    switch (eval_) {
+    case Eval::Never:
+        std::memset(mask, 0, words * sizeof *mask);
+        return;
+    case Eval::Int:
+        simd::cmpInt64(b.values<int64_t>(k), n, op_, int_, mask);
+        simd::clearNulls(mask, b.nulls(k), n);
+        return;
+    case Eval::Double:
+        simd::cmpDouble(b.values<double>(k), n, op_, dbl_, mask);
+        simd::clearNulls(mask, b.nulls(k), n);
+        return;
+    case Eval::Text:
+        if (b.inPlace() && textCells_ && (kind_ == Kind::Prefix || op_ == CmpOp::Eq)) {
+            simd::textCells(b.cells(k), b.page(), n, value_.text, kind_ == Kind::Prefix, mask);
+            simd::clearNulls(mask, b.nulls(k), n);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+
+    // the rest (BOOL, CHAR, TEXT ordering, gathered TEXT …): row by row
+    std::memset(mask, 0, words * sizeof *mask);
+    for (uint16_t r = 0; r < n; ++r)
+        if (matches(ColumnRow(b, r))) mask[r >> 6] |= uint64_t(1) << (r & 63);
+}
+
+} // namespace elvoiddb::storage
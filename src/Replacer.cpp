@@ -0,0 +1,197 @@
+#include "Replacer.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace elvoiddb::storage {
+
+ReplacementPolicy parsePolicy(const std::string& name)
+{
+    if (name == "lru")                    return ReplacementPolicy::Lru;
+    if (name == "clock")                  return ReplacementPolicy::Clock;
+    if (name == "lru-k" || name == "lru2") return ReplacementPolicy::LruK;
+    if (name == "2q")                     return ReplacementPolicy::TwoQ;
+    throw StorageError("unknown replacement policy " + name);
+}
+
+const char* policyName(ReplacementPolicy p)
+{
+    switch (p) {
+    case ReplacementPolicy::Lru:   return "lru";
+    case ReplacementPolicy::Clock: return "clock";
+    case ReplacementPolicy::LruK:  return "lru-k";
+    case ReplacementPolicy::TwoQ:  return "2q";
+    }
+    return "?";
+}
+
+namespace {
+
+/* ─── LRU: exact recency list, one splice per hit ───────────── */
+class LruReplacer : public Replacer {
+    std::list<size_t>                        lru_;   // front = most recent
+    std::vector<std::list<size_t>::iterator> pos_;
+    std::vector<bool>                        in_;
+
+    void ensure(size_t f) {
+        if (f >= in_.size()) { pos_.resize(f + 1); in_.resize(f + 1, false); }
+    }
+public:
+    void recordAccess(size_t f, uint64_t, bool) override {
+        ensure(f);
+        if (in_[f]) lru_.splice(lru_.begin(), lru_, pos_[f]);
+        else        { pos_[f] = lru_.insert(lru_.begin(), f); in_[f] = true; }
+    }
+    void remove(size_t f) override {
+        if (f < in_.size() && in_[f]) { lru_.erase(pos_[f]); in_[f] = false; }
+    }
+    std::optional<size_t> victim(const std::function<bool(size_t)>& ok) override {
+        for (auto it = lru_.rbegin(); it != lru_.rend(); ++it)
+            if (ok(*it)) return *it;
+        return std::nullopt;
+    }
+};
+
+/* ─── CLOCK: a hit only sets a reference bit ────────────────── */
+class ClockReplacer : public Replacer {
+    std::vector<uint8_t> ref_, in_;
+    size_t               hand_{0};
+
+    void ensure(size_t f) {
+        if (f >= in_.size()) { ref_.resize(f + 1, 0); in_.resize(f + 1, 0); }
+    }
+public:
+    void recordAccess(size_t f, uint64_t, bool) override { ensure(f); in_[f] = 1; ref_[f] = 1; }
+    void remove(size_t f) override {
+        if (f < in_.size()) in_[f] = ref_[f] = 0;
+    }
+    std::optional<size_t> victim(const std::function<bool(size_t)>& ok) override {
+        size_t n = in_.size();
+        for (size_t step = 0; step < 2 * n; ++step) {          // two sweeps clear every bit
+            size_t f = hand_;
+            hand_ = (hand_ + 1) % n;
+            if (!in_[f] || !ok(f)) continue;
+            if (ref_[f]) { ref_[f] = 0; continue; }            // second chance
+            return f;
+        }
+        return std::nullopt;
+    }
+};
+
+/* ─── LRU-K (K = 2): evict the largest backward 2-distance ─────
+   Pages referenced once (e.g. by a scan) have infinite distance and go
+   first, oldest first. History is kept per resident frame only.      */
+class LruKReplacer : public Replacer {
+    struct Hist { uint64_t last{0}, prev{0}; bool in{false}; };   // prev 0 → < K refs
+    std::vector<Hist> h_;
+    uint64_t          now_{0};
+public:
+    void recordAccess(size_t f, uint64_t, bool loaded) override {
+        if (f >= h_.size()) h_.resize(f + 1);
+        Hist& x = h_[f];
+        ++now_;
+        if (loaded || !x.in) x.prev = 0;
+        else                 x.prev = x.last;
+        x.last = now_;
+        x.in   = true;
+    }
+    void remove(size_t f) override {
+        if (f < h_.size()) h_[f] = Hist{};
+    }
+    std::optional<size_t> victim(const std::function<bool(size_t)>& ok) override {
+        std::optional<size_t> best;
+        bool     bestInf = false;
+        uint64_t bestTs  = 0;
+        for (size_t f = 0; f < h_.size(); ++f) {
+            const Hist& x = h_[f];
+            if (!x.in || !ok(f)) continue;
+            bool     inf = x.prev == 0;
+            uint64_t ts  = inf ? x.last : x.prev;
+            if (!best || (inf && !bestInf) || (inf == bestInf && ts < bestTs)) {
+                best = f; bestInf = inf; bestTs = ts;
+            }
+        }
+        return best;
+    }
+};
+
+/* ─── 2Q: FIFO probation queue + LRU main queue + ghost list ───
+   First-time pages enter A1in; only pages re-read after falling out of
+   A1in (still remembered in A1out) are promoted to Am, so one-shot
+   scans cycle through A1in without touching the hot set.             */
+class TwoQReplacer : public Replacer {
+    enum Where : uint8_t { None, In, Main };
+
+    size_t                                   kin_, kout_;
+    std::list<size_t>                        a1in_;   // front = oldest
+    std::list<size_t>                        am_;     // front = most recent
+    std::list<uint64_t>                      a1out_;  // front = oldest ghost
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> ghosts_;
+    std::vector<Where>                       where_;
+    std::vector<std::list<size_t>::iterator> pos_;
+    std::vector<uint64_t>                    key_;
+
+    void ensure(size_t f) {
+        if (f >= where_.size()) {
+            where_.resize(f + 1, None); pos_.resize(f + 1); key_.resize(f + 1, 0);
+        }
+    }
+    void remember(uint64_t key) {
+        if (ghosts_.count(key)) return;
+        ghosts_[key] = a1out_.insert(a1out_.end(), key);
+        if (a1out_.size() > kout_) { ghosts_.erase(a1out_.front()); a1out_.pop_front(); }
+    }
+public:
+    explicit TwoQReplacer(size_t cap)
+        : kin_(std::max<size_t>(1, cap / 4)), kout_(std::max<size_t>(1, cap / 2)) {}
+
+    void recordAccess(size_t f, uint64_t key, bool loaded) override {
+        ensure(f);
+        if (!loaded && where_[f] == Main) { am_.splice(am_.begin(), am_, pos_[f]); return; }
+        if (!loaded && where_[f] == In)   return;           // correlated re-reference
+        key_[f] = key;
+        if (auto g = ghosts_.find(key); g != ghosts_.end()) {
+            a1out_.erase(g->second);
+            ghosts_.erase(g);
+            pos_[f] = am_.insert(am_.begin(), f);
+            where_[f] = Main;
+        } else {
+            pos_[f] = a1in_.insert(a1in_.end(), f);
+            where_[f] = In;
+        }
+    }
+    void remove(size_t f) override {
+        if (f >= where_.size()) return;
+        if (where_[f] == In)   { a1in_.erase(pos_[f]); remember(key_[f]); }
+        if (where_[f] == Main) am_.erase(pos_[f]);
+        where_[f] = None;
+    }
+    std::optional<size_t> victim(const std::function<bool(size_t)>& ok) override {
+        auto fromIn = [&]() -> std::optional<size_t> {
+            for (size_t f : a1in_) if (ok(f)) return f;
+            return std::nullopt;
+        };
+        if (a1in_.size() > kin_ || am_.empty())
+            if (auto v = fromIn()) return v;
+        for (auto it = am_.rbegin(); it != am_.rend(); ++it)
+            if (ok(*it)) return *it;
+        return fromIn();
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Replacer> makeReplacer(ReplacementPolicy p, size_t capacity)
+{
+    switch (p) {
+    case ReplacementPolicy::Clock: return std::make_unique<ClockReplacer>();
+    case ReplacementPolicy::LruK:  return std::make_unique<LruKReplacer>();
+    case ReplacementPolicy::TwoQ:  return std::make_unique<TwoQReplacer>(capacity);
+    case ReplacementPolicy::Lru:   break;
+    }
+    return std::make_unique<LruReplacer>();
+}
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,379 @@
+#include "Schema.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace elvoiddb::storage {
+
+namespace {
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back())))  s.remove_suffix(1);
+    return s;
+}
+
+std::string upper(std::string_view s)
+{
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(), ::toupper);
+    return out;
+}
+
+bool iequals(std::string_view a, const char* b)
+{
+    size_t n = std::strlen(b);
+    if (a.size() != n) return false;
+    for (size_t i = 0; i < n; ++i)
+        if (std::toupper(static_cast<unsigned char>(a[i])) != b[i]) return false;
+    return true;
+}
+
+// "INT", "CHAR(8)", "varchar(20)" … → column type (+ CHAR width)
+void parseType(std::string_view text, Column& c)
+{
+    std::string t = upper(text);
+    t.erase(std::remove_if(t.begin(), t.end(), ::isspace), t.end());
+
+    std::string base = t.substr(0, t.find('('));
+    size_t width = 0;
+    if (base.size() != t.size()) {                     // "(n)"
+        if (t.back() != ')') throw ParseError("bad type " + std::string(text));
+        auto digits = std::string_view(t).substr(base.size() + 1, t.size() - base.size() - 2);
+        auto [p, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), width);
+        if (ec != std::errc() || p != digits.data() + digits.size())
+            throw ParseError("bad type " + std::string(text));
+    }
+
+    if (base == "INT" || base == "INTEGER" || base == "BIGINT" || base == "INT64") {
+        c.type = ColType::Int64;
+    } else if (base == "DOUBLE" || base == "FLOAT" || base == "REAL") {
+        c.type = ColType::Double;
+    } else if (base == "BOOL" || base == "BOOLEAN") {
+        c.type = ColType::Bool;
+    } else if (base == "TEXT" || base == "VARCHAR" || base == "STRING") {
+        c.type = ColType::Text;
+    } else if (base == "CHAR") {
+        if (base.size() == t.size()) width = 1;
+        if (width == 0 || width > 255) throw ParseError("CHAR width must be 1..255");
+        c.type  = ColType::Char;
+        c.width = static_cast<uint16_t>(width);
+    } else {
+        throw ParseError("unknown type " + std::string(text));
+    }
+}
+
+uint16_t slotSize(const Column& c)
+{
+    switch (c.type) {
+    case ColType::Int64:
+    case ColType::Double: return 8;
+    case ColType::Bool:   return 1;
+    case ColType::Char:   return c.width;
+    case ColType::Text:   return sizeof(uint16_t);       // end offset
+    }
+    return 0;
+}
+
+[[noreturn]] void badValue(const Column& c, std::string_view v)
+{
+    throw ExecutionError("column " + c.name + ": '" + std::string(v) + "' is not " +
+                         Schema::typeName(c.type));
+}
+
+} // namespace
+
+/* ─── Schema ────────────────────────────────────────────────── */
+
+const char* Schema::typeName(ColType t)
+{
+    switch (t) {
+    case ColType::Int64:  return "INT64";
+    case ColType::Double: return "DOUBLE";
+    case ColType::Bool:   return "BOOL";
+    case ColType::Text:   return "TEXT";
+    case ColType::Char:   return "CHAR";
+    }
+    return "?";
+}
+
+void Schema::layout()
+{
+    offset_.clear();
+    prevText_.clear();
+    uint16_t off  = static_cast<uint16_t>((cols_.size() + 7) / 8);
+    uint16_t prev = kNone;
+    for (const auto& c : cols_) {
+        offset_.push_back(off);
+        prevText_.push_back(prev);
+        if (c.type == ColType::Text) prev = off;
+        off += slotSize(c);
+    }
+    fixedEnd_ = off;
+}
+
+Schema Schema::fromDefs(const std::vector<std::string>& defs)
+{
+    Schema s;
+    for (const auto& d : defs) {
+        std::string_view def = trim(d);
+        size_t sp = def.find_first_of(" \t");
+        Column c;
+        c.name = std::string(def.substr(0, sp));
+        if (c.name.empty()) throw ParseError("empty column name");
+        if (sp != std::string_view::npos) parseType(trim(def.substr(sp)), c);
+        for (const auto& o : s.cols_)
+            if (o.name == c.name) throw ParseError("duplicate column " + c.name);
+        s.cols_.push_back(std::move(c));
+    }
+    s.layout();
+    return s;
+}
+
+Schema Schema::fromCatalog(std::string_view text)
+{
+    Schema s;
+    text = text.substr(0, text.find('\n'));         // further lines: the table's indexes
+    bool pax   = text.rfind("pax:", 0) == 0;
+    bool typed = pax || text.rfind("schema:", 0) == 0;
+    if (!typed && text.rfind("cols:", 0) != 0) return s;
+    text.remove_prefix(pax ? 4 : typed ? 7 : 5);
+    if (pax) s.pageLayout_ = PageLayout::Pax;
+
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view entry = text.substr(0, comma);
+        text.remove_prefix(comma == std::string_view::npos ? text.size() : comma + 1);
+
+        Column c;
+        if (typed) {
+            size_t sp = entry.find(' ');
+            c.name = std::string(entry.substr(0, sp));
+            if (sp != std::string_view::npos) parseType(entry.substr(sp + 1), c);
+        } else {
+            c.name = std::string(entry);
+        }
+        s.cols_.push_back(std::move(c));
+    }
+    s.legacy_ = !typed;
+    if (typed) s.layout();
+    return s;
+}
+
+std::string Schema::catalog() const
+{
+    std::string out = legacy_ ? "cols:" : pageLayout_ == PageLayout::Pax ? "pax:" : "schema:";
+    for (size_t i = 0; i < cols_.size(); ++i) {
+        if (i) out += ',';
+        out += cols_[i].name;
+        if (legacy_) continue;
+        out += ' ';
+        out += typeName(cols_[i].type);
+        if (cols_[i].type == ColType::Char) out += '(' + std::to_string(cols_[i].width) + ')';
+    }
+    return out;
+}
+
+void Schema::setPageLayout(PageLayout l)
+{
+    if (l == PageLayout::Pax && legacy_) throw StorageError("PAX layout needs typed columns");
+    pageLayout_ = l;
+}
+
+std::vector<std::string> Schema::names() const
+{
+    std::vector<std::string> out;
+    for (const auto& c : cols_) out.push_back(c.name);
+    return out;
+}
+
+void Schema::encode(const std::vector<std::string>& values, std::string& out,
+                    Literal spelling) const
+{
+    encodeAs(values, out, spelling);
+}
+
+void Schema::encode(const std::vector<std::string_view>& values, std::string& out,
+                    Literal spelling) const
+{
+    encodeAs(values, out, spelling);
+}
+
+template <typename Str>
+void Schema::encodeAs(const std::vector<Str>& values, std::string& out, Literal spelling) const
+{
+    if (values.size() != cols_.size()) throw ExecutionError("column count mismatch");
+
+    if (legacy_) {                                     // u16 count, u16 len + bytes each
+        out.clear();
+        uint16_t cnt = static_cast<uint16_t>(values.size());
+        out.append(reinterpret_cast<const char*>(&cnt), sizeof cnt);
+        for (std::string_view v : values) {
+            uint16_t len = static_cast<uint16_t>(v.size());
+            out.append(reinterpret_cast<const char*>(&len), sizeof len);
+            out.append(v.data(), v.size());
+        }
+        return;
+    }
+
+    out.assign(fixedEnd_, '\0');
+    std::string unq;
+    for (size_t i = 0; i < cols_.size(); ++i) {
+        const Column& c = cols_[i];
+        std::string_view v = values[i];
+        bool text = c.type == ColType::Text || c.type == ColType::Char;
+
+        bool isNull;
+        if (spelling == Literal::Sql) {
+            v = trim(v);
+            isNull = iequals(v, "NULL");
+            if (v.size() >= 2 && v.front() == '\'' && v.back() == '\'') {   // 'it''s'
+                unq.clear();
+                for (size_t k = 1; k + 1 < v.size(); ++k) {
+                    unq += v[k];
+                    if (v[k] == '\'' && v[k + 1] == '\'') ++k;
+                }
+                v = unq;
+            }
+        } else {
+            isNull = v.empty() && !text;
+        }
+        char* slot = out.data() + offset_[i];
+        if (isNull) {
+            out[i >> 3] = static_cast<char>(out[i >> 3] | (1 << (i & 7)));
+            if (c.type == ColType::Text) {                 // empty: the next TEXT starts here
+                uint16_t end = static_cast<uint16_t>(out.size());
+                std::memcpy(slot, &end, sizeof end);
+            }
+            continue;
+        }
+
+        switch (c.type) {
+        case ColType::Int64: {
+            std::string_view n = trim(v);
+            if (!n.empty() && n.front() == '+') n.remove_prefix(1);
+            int64_t x;
+            auto [p, ec] = std::from_chars(n.data(), n.data() + n.size(), x);
+            if (n.empty() || ec != std::errc() || p != n.data() + n.size()) badValue(c, v);
+            std::memcpy(slot, &x, sizeof x);
+            break;
+        }
+        case ColType::Double: {
+            std::string_view n = trim(v);
+            if (!n.empty() && n.front() == '+') n.remove_prefix(1);
+            double x;
+            auto [p, ec] = std::from_chars(n.data(), n.data() + n.size(), x);
+            if (n.empty() || ec != std::errc() || p != n.data() + n.size()) badValue(c, v);
+            std::memcpy(slot, &x, sizeof x);
+            break;
+        }
+        case ColType::Bool: {
+            std::string_view b = trim(v);
+            if      (iequals(b, "TRUE")  || iequals(b, "T") || b == "1" || iequals(b, "YES")) *slot = 1;
+            else if (iequals(b, "FALSE") || iequals(b, "F") || b == "0" || iequals(b, "NO"))  *slot = 0;
+            else badValue(c, v);
+            break;
+        }
+        case ColType::Char:
+            if (v.size() > c.width)
+                throw ExecutionError("column " + c.name + ": value too long for CHAR(" +
+                                     std::to_string(c.width) + ")");
+            std::memcpy(slot, v.data(), v.size());
+            std::memset(slot + v.size(), ' ', c.width - v.size());
+            break;
+        case ColType::Text: {
+            if (out.size() + v.size() > UINT16_MAX) throw StorageError("row too large");
+            uint16_t end = static_cast<uint16_t>(out.size() + v.size());
+            std::memcpy(slot, &end, sizeof end);         // before append: `slot` may move
+            out.append(v.data(), v.size());
+            break;
+        }
+        }
+    }
+}
+
+bool Schema::valid(const char* rec, uint16_t len) const
+{
+    if (legacy_) {
+        if (len < sizeof(uint16_t)) return false;
+        uint16_t cnt;
+        std::memcpy(&cnt, rec, sizeof cnt);
+        if (cnt != cols_.size()) return false;
+        size_t p = sizeof cnt;
+        while (cnt--) {
+            if (p + sizeof(uint16_t) > len) return false;
+            uint16_t flen;
+            std::memcpy(&flen, rec + p, sizeof flen);
+            p += sizeof flen + flen;
+        }
+        return p <= len;
+    }
+    if (len < fixedEnd_) return false;
+    uint16_t start = fixedEnd_;
+    for (size_t i = 0; i < cols_.size(); ++i) {
+        if (cols_[i].type != ColType::Text) continue;
+        uint16_t end;
+        std::memcpy(&end, rec + offset_[i], sizeof end);
+        if (end < start || end > len) return false;
+        start = end;
+    }
+    return true;
+}
+
+/* ─── RowRef ────────────────────────────────────────────────── */
+
+std::string_view RowRef::legacyField(size_t i) const
+{
+    const char* p = rec_ + sizeof(uint16_t);
+    for (;;) {
+        uint16_t len;
+        std::memcpy(&len, p, sizeof len);
+        p += sizeof len;
+        if (i-- == 0) return {p, len};
+        p += len;
+    }
+}
+
+std::string_view RowRef::getText(size_t i) const
+{
+    if (schema_->legacy()) return legacyField(i);
+    const char* slot = rec_ + schema_->offset(i);
+    if ((*schema_)[i].type == ColType::Char) {
+        std::string_view v(slot, (*schema_)[i].width);
+        while (!v.empty() && v.back() == ' ') v.remove_suffix(1);
+        return v;
+    }
+    uint16_t start = schema_->fixedSize(), end;
+    if (uint16_t prev = schema_->prevText(i); prev != Schema::kNone)
+        std::memcpy(&start, rec_ + prev, sizeof start);
+    std::memcpy(&end, slot, sizeof end);
+    return {rec_ + start, size_t(end - start)};
+}
+
+void RowRef::format(size_t i, std::string& out) const
+{
+    if (isNull(i)) { out += "NULL"; return; }
+    char buf[32];
+    switch ((*schema_)[i].type) {
+    case ColType::Int64: {
+        auto r = std::to_chars(buf, buf + sizeof buf, getInt(i));
+        out.append(buf, r.ptr);
+        break;
+    }
+    case ColType::Double: {
+        auto r = std::to_chars(buf, buf + sizeof buf, getDouble(i));
+        out.append(buf, r.ptr);
+        break;
+    }
+    case ColType::Bool:
+        out += getBool(i) ? "true" : "false";
+        break;
+    case ColType::Text:
+    case ColType::Char:
+        out += getText(i);
+        break;
+    }
+}
+
+} // namespace elvoiddb::storage
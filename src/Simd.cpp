@@ -0,0 +1,374 @@
+#include "Simd.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ELVOIDDB_X86 1
+#include <immintrin.h>
+#endif
+
+namespace elvoiddb::storage::simd {
+
+namespace {
+
+/* ─── scalar ────────────────────────────────────────────────── */
+
+template <typename T, typename F>
+void scalarLoop(const T* v, size_t n, F f, uint64_t* mask)
+{
+    for (size_t w = 0, base = 0; base < n; ++w, base += 64) {
+        size_t   m    = std::min<size_t>(64, n - base);
+        uint64_t bits = 0;
+        for (size_t j = 0; j < m; ++j) bits |= uint64_t(f(v[base + j])) << j;
+        mask[w] = bits;
+    }
+}
+
+template <typename T>
+void cmpScalar(const T* v, size_t n, CmpOp op, T k, uint64_t* mask)
+{
+    switch (op) {
+    case CmpOp::Eq: scalarLoop(v, n, [k](T x) { return x == k; }, mask); break;
+    case CmpOp::Ne: scalarLoop(v, n, [k](T x) { return x != k; }, mask); break;
+    case CmpOp::Lt: scalarLoop(v, n, [k](T x) { return x <  k; }, mask); break;
+    case CmpOp::Le: scalarLoop(v, n, [k](T x) { return x <= k; }, mask); break;
+    case CmpOp::Gt: scalarLoop(v, n, [k](T x) { return x >  k; }, mask); break;
+    case CmpOp::Ge: scalarLoop(v, n, [k](T x) { return x >= k; }, mask); break;
+    }
+}
+
+void cmpInt64Scalar(const int64_t* v, size_t n, CmpOp op, int64_t k, uint64_t* mask)
+{
+    cmpScalar(v, n, op, k, mask);
+}
+
+void cmpDoubleScalar(const double* v, size_t n, CmpOp op, double k, uint64_t* mask)
+{
+    cmpScalar(v, n, op, k, mask);
+}
+
+struct TextCell { uint16_t off, len; };
+
+TextCell textCell(const char* cells, size_t r)
+{
+    TextCell c;
+    std::memcpy(&c, cells + r * sizeof c, sizeof c);
+    return c;
+}
+
+// drop candidates (bits set from a length test) whose bytes differ
+void verifyText(const char* cells, const char* page, size_t n, std::string_view s,
+                uint64_t* mask)
+{
+    if (s.empty()) return;                             // length test was the whole answer
+    for (size_t w = 0; w < maskWords(n); ++w)
+        for (uint64_t bits = mask[w]; bits; bits &= bits - 1) {
+            size_t r = w * 64 + __builtin_ctzll(bits);
+            if (std::memcmp(page + textCell(cells, r).off, s.data(), s.size()) != 0)
+                mask[w] &= ~(uint64_t(1) << (r & 63));
+        }
+}
+
+void textLenScalar(const char* cells, size_t n, size_t len, bool prefix, uint64_t* mask)
+{
+    for (size_t w = 0, base = 0; base < n; ++w, base += 64) {
+        size_t   m    = std::min<size_t>(64, n - base);
+        uint64_t bits = 0;
+        for (size_t j = 0; j < m; ++j) {
+            uint16_t l = textCell(cells, base + j).len;
+            bits |= uint64_t(prefix ? l >= len : l == len) << j;
+        }
+        mask[w] = bits;
+    }
+}
+
+#ifdef ELVOIDDB_X86
+
+/* ─── SSE4.2 / AVX2 ─────────────────────────────────────────────
+   Each word of 64 rows runs whole vectors while they fit and finishes
+   the last few rows scalar, so a short page batch stays mostly SIMD.
+   Integers only have == and >: Kind picks x == k (0), x > k (1) or
+   k > x (2), and `invert` turns those into !=, <= and >=.            */
+
+template <int Kind>
+inline bool intBase(int64_t x, int64_t k) { return Kind == 0 ? x == k : Kind == 1 ? x > k : k > x; }
+
+inline uint64_t lowBits(size_t m) { return m == 64 ? ~uint64_t(0) : (uint64_t(1) << m) - 1; }
+
+template <CmpOp Op, typename T>
+inline bool test(T x, T k)
+{
+    switch (Op) {
+    case CmpOp::Eq: return x == k;
+    case CmpOp::Ne: return x != k;
+    case CmpOp::Lt: return x <  k;
+    case CmpOp::Le: return x <= k;
+    case CmpOp::Gt: return x >  k;
+    case CmpOp::Ge: return x >= k;
+    }
+    return false;
+}
+
+template <int Kind>
+__attribute__((target("sse4.2")))
+void cmpInt64Sse(const int64_t* v, size_t n, int64_t k, bool invert, uint64_t* mask)
+{
+    const __m128i K = _mm_set1_epi64x(k);
+    for (size_t w = 0, base = 0; base < n; ++w, base += 64) {
+        const int64_t* p    = v + base;
+        size_t         m    = std::min<size_t>(64, n - base), j = 0;
+        uint64_t       bits = 0;
+        for (; j + 2 <= m; j += 2) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + j));
+            __m128i c = Kind == 0 ? _mm_cmpeq_epi64(x, K)
+                      : Kind == 1 ? _mm_cmpgt_epi64(x, K) : _mm_cmpgt_epi64(K, x);
+            bits |= uint64_t(_mm_movemask_pd(_mm_castsi128_pd(c))) << j;
+        }
+        for (; j < m; ++j) bits |= uint64_t(intBase<Kind>(p[j], k)) << j;
+        mask[w] = invert ? ~bits & lowBits(m) : bits;
+    }
+}
+
+template <int Kind>
+__attribute__((target("avx2")))
+void cmpInt64Avx(const int64_t* v, size_t n, int64_t k, bool invert, uint64_t* mask)
+{
+    const __m256i K = _mm256_set1_epi64x(k);
+    for (size_t w = 0, base = 0; base < n; ++w, base += 64) {
+        const int64_t* p    = v + base;
+        size_t         m    = std::min<size_t>(64, n - base), j = 0;
+        uint64_t       bits = 0;
+        for (; j + 4 <= m; j += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + j));
+            __m256i c = Kind == 0 ? _mm256_cmpeq_epi64(x, K)
+                      : Kind == 1 ? _mm256_cmpgt_epi64(x, K) : _mm256_cmpgt_epi64(K, x);
+            bits |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(c))) << j;
+        }
+        for (; j < m; ++j) bits |= uint64_t(intBase<Kind>(p[j], k)) << j;
+        mask[w] = invert ? ~bits & lowBits(m) : bits;
+    }
+}
+
+template <CmpOp Op>
+__attribute__((target("sse4.2")))
+void cmpDoubleSse(const double* v, size_t n, double k, uint64_t* mask)
+{
+    const __m128d K = _mm_set1_pd(k);
+    for (size_t w = 0, base = 0; base < n; ++w, base += 64) {
+        const double* p    = v + base;
+        size_t        m    = std::min<size_t>(64, n - base), j = 0;
+        uint64_t      bits = 0;
+        for (; j + 2 <= m; j += 2) {
+            __m128d x = _mm_loadu_pd(p + j);
+            __m128d c = Op == CmpOp::Eq ? _mm_cmpeq_pd(x, K) : Op == CmpOp::Ne ? _mm_cmpneq_pd(x, K)
+                      : Op == CmpOp::Lt ? _mm_cmplt_pd(x, K) : Op == CmpOp::Le ? _mm_cmple_pd(x, K)
+                      : Op == CmpOp::Gt ? _mm_cmpgt_pd(x, K) : _mm_cmpge_pd(x, K);
+            bits |= uint64_t(_mm_movemask_pd(c)) << j;
+        }
+        for (; j < m; ++j) bits |= uint64_t(test<Op>(p[j], k)) << j;
+        mask[w] = bits;
+    }
+}
+
+// NEQ_UQ: NaN != k, as in C++; the rest are false on NaN
+constexpr int avxPredicate(CmpOp op)
+{
+    return op == CmpOp::Eq ? _CMP_EQ_OQ : op == CmpOp::Ne ? _CMP_NEQ_UQ
+         : op == CmpOp::Lt ? _CMP_LT_OQ : op == CmpOp::Le ? _CMP_LE_OQ
+         : op == CmpOp::Gt ? _CMP_GT_OQ : _CMP_GE_OQ;
+}
+
+template <CmpOp Op>
+__attribute__((target("avx2")))
+void cmpDoubleAvx(const double* v, size_t n, double k, uint64_t* mask)
+{
+    constexpr int P = avxPredicate(Op);
+    const __m256d K = _mm256_set1_pd(k);
+    for (size_t w = 0, base = 0; base < n; ++w, base += 64) {
+        const double* p    = v + base;
+        size_t        m    = std::min<size_t>(64, n - base), j = 0;
+        uint64_t      bits = 0;
+        for (; j + 4 <= m; j += 4) {
+            __m256d c = _mm256_cmp_pd(_mm256_loadu_pd(p + j), K, P);
+            bits |= uint64_t(_mm256_movemask_pd(c)) << j;
+        }
+        for (; j < m; ++j) bits |= uint64_t(test<Op>(p[j], k)) << j;
+        mask[w] = bits;
+    }
+}
+
+// 8 cells per vector: shift {off, len} down to len, compare with the literal's
+__attribute__((target("avx2")))
+void textLenAvx2(const char* cells, size_t n, size_t len, bool prefix, uint64_t* mask)
+{
+    if (prefix && len == 0) return textLenScalar(cells, n, len, prefix, mask);   // all match
+    const __m256i L = _mm256_set1_epi32(static_cast<int>(prefix ? len - 1 : len));
+    for (size_t w = 0, base = 0; base < n; ++w, base += 64) {
+        const char* p    = cells + base * sizeof(TextCell);
+        size_t      m    = std::min<size_t>(64, n - base), j = 0;
+        uint64_t    bits = 0;
+        for (; j + 8 <= m; j += 8) {
+            __m256i x    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + j * sizeof(TextCell)));
+            __m256i lens = _mm256_srli_epi32(x, 16);
+            __m256i c    = prefix ? _mm256_cmpgt_epi32(lens, L) : _mm256_cmpeq_epi32(lens, L);
+            bits |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(c))) << j;
+        }
+        for (; j < m; ++j) {
+            uint16_t l = textCell(p, j).len;
+            bits |= uint64_t(prefix ? l >= len : l == len) << j;
+        }
+        mask[w] = bits;
+    }
+}
+
+template <bool Avx>
+void cmpInt64Vec(const int64_t* v, size_t n, CmpOp op, int64_t k, uint64_t* mask)
+{
+    bool inv  = op == CmpOp::Ne || op == CmpOp::Le || op == CmpOp::Ge;
+    int  kind = op == CmpOp::Eq || op == CmpOp::Ne ? 0 : op == CmpOp::Gt || op == CmpOp::Le ? 1 : 2;
+    auto run  = kind == 0 ? (Avx ? cmpInt64Avx<0> : cmpInt64Sse<0>)
+              : kind == 1 ? (Avx ? cmpInt64Avx<1> : cmpInt64Sse<1>)
+                          : (Avx ? cmpInt64Avx<2> : cmpInt64Sse<2>);
+    run(v, n, k, inv, mask);
+}
+
+void cmpInt64Sse42(const int64_t* v, size_t n, CmpOp op, int64_t k, uint64_t* mask)
+{
+    cmpInt64Vec<false>(v, n, op, k, mask);
+}
+
+void cmpInt64Avx2(const int64_t* v, size_t n, CmpOp op, int64_t k, uint64_t* mask)
+{
+    cmpInt64Vec<true>(v, n, op, k, mask);
+}
+
+template <bool Avx>
+void cmpDoubleVec(const double* v, size_t n, CmpOp op, double k, uint64_t* mask)
+{
+    switch (op) {
+    case CmpOp::Eq: (Avx ? cmpDoubleAvx<CmpOp::Eq> : cmpDoubleSse<CmpOp::Eq>)(v, n, k, mask); break;
+    case CmpOp::Ne: (Avx ? cmpDoubleAvx<CmpOp::Ne> : cmpDoubleSse<CmpOp::Ne>)(v, n, k, mask); break;
+    case CmpOp::Lt: (Avx ? cmpDoubleAvx<CmpOp::Lt> : cmpDoubleSse<CmpOp::Lt>)(v, n, k, mask); break;
+    case CmpOp::Le: (Avx ? cmpDoubleAvx<CmpOp::Le> : cmpDoubleSse<CmpOp::Le>)(v, n, k, mask); break;
+    case CmpOp::Gt: (Avx ? cmpDoubleAvx<CmpOp::Gt> : cmpDoubleSse<CmpOp::Gt>)(v, n, k, mask); break;
+    case CmpOp::Ge: (Avx ? cmpDoubleAvx<CmpOp::Ge> : cmpDoubleSse<CmpOp::Ge>)(v, n, k, mask); break;
+    }
+}
+
+void cmpDoubleSse42(const double* v, size_t n, CmpOp op, double k, uint64_t* mask)
+{
+    cmpDoubleVec<false>(v, n, op, k, mask);
+}
+
+void cmpDoubleAvx2(const double* v, size_t n, CmpOp op, double k, uint64_t* mask)
+{
+    cmpDoubleVec<true>(v, n, op, k, mask);
+}
+
+#endif // ELVOIDDB_X86
+
+/* ─── dispatch ──────────────────────────────────────────────── */
+
+struct Kernels {
+    Isa  isa;
+    void (*i64)(const int64_t*, size_t, CmpOp, int64_t, uint64_t*);
+    void (*f64)(const double*,  size_t, CmpOp, double,  uint64_t*);
+    void (*textLen)(const char*, size_t, size_t, bool, uint64_t*);
+};
+
+Kernels kernelsFor(Isa i)
+{
+#ifdef ELVOIDDB_X86
+    if (i == Isa::Avx2)  return {i, cmpInt64Avx2,  cmpDoubleAvx2,  textLenAvx2};
+    if (i == Isa::Sse42) return {i, cmpInt64Sse42, cmpDoubleSse42, textLenScalar};
+#endif
+    return {Isa::Scalar, cmpInt64Scalar, cmpDoubleScalar, textLenScalar};
+}
+
+Kernels& kernels()
+{
+    static Kernels k = [] {
+        Isa best = supported(Isa::Avx2) ? Isa::Avx2 : supported(Isa::Sse42) ? Isa::Sse42 : Isa::Scalar;
+        if (const char* env = std::getenv("ELVOIDDB_SIMD")) {
+            std::string want(env);
+            Isa cap = want == "scalar" ? Isa::Scalar : want == "sse42" ? Isa::Sse42 : Isa::Avx2;
+            best = std::min(best, cap);
+        }
+        return kernelsFor(best);
+    }();
+    return k;
+}
+
+} // namespace
+
+bool supported(Isa i)
+{
+    switch (i) {
+    case Isa::Scalar: return true;
+#ifdef ELVOIDDB_X86
+    case Isa::Sse42:  return __builtin_cpu_supports("sse4.2");
+    case Isa::Avx2:   return __builtin_cpu_supports("avx2");
+#else
+    default:          return false;
+#endif
+    }
+    return false;
+}
+
+Isa isa() { return kernels().isa; }
+
+const char* isaName(Isa i)
+{
+    switch (i) {
+    case Isa::Scalar: return "scalar";
+    case Isa::Sse42:  return "sse42";
+    case Isa::Avx2:   return "avx2";
+    }
+    return "?";
+}
+
+bool setIsa(Isa i)
+{
+    if (!supported(i)) return false;
+    kernels() = kernelsFor(i);
+    return true;
+}
+
+void cmpInt64(const int64_t* v, size_t n, CmpOp op, int64_t k, uint64_t* mask)
+{
+    kernels().i64(v, n, op, k, mask);
+}
+
+void cmpDouble(const double* v, size_t n, CmpOp op, double k, uint64_t* mask)
+{
+    kernels().f64(v, n, op, k, mask);
+}
+
+void textCells(const char* cells, const char* page, size_t n, std::string_view s,
+               bool prefix, uint64_t* mask)
+{
+    kernels().textLen(cells, n, s.size(), prefix, mask);
+    verifyText(cells, page, n, s, mask);
+}
+
+void clearNulls(uint64_t* mask, const uint8_t* nulls, size_t n)
+{
+    for (size_t w = 0; w < maskWords(n); ++w) {
+        uint64_t nb = 0;
+        std::memcpy(&nb, nulls + w * 8, std::min<size_t>(8, (n - w * 64 + 7) / 8));
+        mask[w] &= ~nb;
+    }
+}
+
+size_t toSelection(const uint64_t* mask, size_t n, uint16_t* sel)
+{
+    size_t c = 0;
+    for (size_t w = 0; w < maskWords(n); ++w)
+        for (uint64_t bits = mask[w]; bits; bits &= bits - 1)
+            sel[c++] = static_cast<uint16_t>(w * 64 + __builtin_ctzll(bits));
+    return c;
+}
+
+} // namespace elvoiddb::storage::simd
@@ -1,204 +1,620 @@
 #include "Storage.hpp"
+#include "Index.hpp"
+#include "Simd.hpp"
+#include "Wal.hpp"
 #include <cstring>
-#include <sstream>
-#include "BufferPool.hpp"
 #include <algorithm>
 
 namespace elvoiddb::storage {
 
 /* ─── BlockFile ─────────────────────────────────────────────── */
 
-BlockFile::BlockFile(const fs::path& p, bool create) : path_(p)
+BlockFile::BlockFile(const fs::path& p, bool create, Access access)
+    : path_(p), id_(gHandles.open(p, create)), fh_(gHandles.get(id_)),
+      pages_(fh_->pageCount())
 {
-    auto mode = std::ios::binary | std::ios::in | std::ios::out;
-    if (create) mode |= std::ios::trunc;
-    file_.open(path_, mode);
-    if (!file_) throw StorageError("cannot open " + path_.string());
-
+    if (access == Access::ReadOnly) {
+        if (create) throw StorageError("cannot create a read-only file");
+        map_ = std::make_unique<MappedFile>(*fh_);
+        pages_ = map_->pageCount();
+    }
     if (create) {
         Page meta;
         writePage(0, meta);                     // page-0 reserved for metadata
     }
 }
 
-/*void BlockFile::writePage(size_t n, const Page& pg)
+void BlockFile::readPage(size_t n, Page& pg) const
 {
-    file_.seekp(n * PAGE_SIZE);
-    file_.write(pg.raw(), PAGE_SIZE);
-    if (!file_) throw StorageError("write fail " + path_.string());
-    file_.flush();
+    if (map_) {
+        if (n >= map_->pageCount()) throw StorageError("page past end of " + path_.string());
+        std::memcpy(pg.raw(), map_->page(n), PAGE_SIZE);
+        return;
+    }
+    // copy out of the buffer-pool frame (callers that can work in place
+    // should fetch a PageGuard instead)
+    auto g = gBufPool.fetch(id_, n, Latch::Shared);
+    std::memcpy(pg.raw(), g.page().raw(), PAGE_SIZE);
 }
 
-void BlockFile::readPage(size_t n, Page& pg) const
+size_t BlockFile::allocatePage()
 {
-    file_.seekg(n * PAGE_SIZE);
-    file_.read(pg.raw(), PAGE_SIZE);
-    if (!file_) throw StorageError("read fail " + path_.string());
-}*/
+    if (map_) throw StorageError(path_.string() + " is read-only");
+    return pages_++;
+}
 
-void BlockFile::readPage(size_t n, Page& pg) const
+void BlockFile::writeDirect(size_t first, const std::vector<const char*>& pages)
 {
-    // fetch from buffer pool → copy into caller-supplied Page
-    Page& frame = gBufPool.get(path_, n);             // pins frame
-    std::memcpy(pg.raw(), frame.raw(), PAGE_SIZE);
-    gBufPool.unpin(path_, n);
+    if (map_) throw StorageError(path_.string() + " is read-only");
+    fh_->writePages(first, pages);
 }
 
-void BlockFile::writePage(size_t n, const Page& pg)
+void BlockFile::truncatePages(size_t n)
 {
-    // 1. update buffer-pool frame
-    Page& frame = gBufPool.get(path_, n);          // pins frame
-    std::memcpy(frame.raw(), pg.raw(), PAGE_SIZE);
-    gBufPool.markDirty(path_, n);
-    gBufPool.unpin(path_, n);
-
-    // 2. write-through so metadata reaches disk immediately
-    /*std::fstream f(path_, std::ios::binary | std::ios::in | std::ios::out);
-    if (!f) {                                      // file might not exist yet
-        f.open(path_, std::ios::binary | std::ios::out); // create
-        f.close();
-        f.open(path_, std::ios::binary | std::ios::in | std::ios::out);
-    }
-    f.seekp(n * PAGE_SIZE);
-    f.write(pg.raw(), PAGE_SIZE);
-    f.flush();*/
+    if (map_) throw StorageError(path_.string() + " is read-only");
+    fh_->truncate(n);
+    pages_ = n;
 }
 
-
-size_t BlockFile::pageCount()
+void BlockFile::writePage(size_t n, const Page& pg, uint64_t lsn)
 {
-    file_.seekg(0, std::ios::end);
-    return static_cast<size_t>(file_.tellg()) / PAGE_SIZE;
+    if (map_) throw StorageError(path_.string() + " is read-only");
+
+    // update buffer-pool frame; the pool writes it back via pwrite
+    auto g = gBufPool.fetch(id_, n, Latch::Exclusive);
+    std::memcpy(g.mutPage().raw(), pg.raw(), PAGE_SIZE);
+    if (lsn) g.setLsn(lsn);
+
+    size_t cur = pages_;
+    while (cur <= n && !pages_.compare_exchange_weak(cur, n + 1)) {}
 }
 
-/* ─── helpers: row (de)serialisation ────────────────────────── */
+/* ─── TableFile ─────────────────────────────────────────────── */
 
-std::string TableFile::serializeRow(const std::vector<std::string>& row)
+TableFile::TableFile(const std::string& t, bool create,
+                     const std::vector<std::string>& cols, PageLayout layout)
+    : name_(t), bf_(t + ".tbl", create)
 {
-    std::string out;
-    uint16_t colCnt = row.size();
-    out.append(reinterpret_cast<const char*>(&colCnt), sizeof(uint16_t));
+    if (create) {
+        schema_ = Schema::fromDefs(cols);
+        schema_.setPageLayout(layout);
+        std::string hdr = schema_.catalog();
+        if (hdr.size() >= PAGE_SIZE) throw StorageError("too many columns");
+        Page meta;
+        std::memcpy(meta.raw(), hdr.data(), hdr.size());
 
-    for (const auto& col : row) {
-        uint16_t len = col.size();
-        out.append(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
-        out.append(col);
+        auto gate = gWal.gate();
+        uint64_t lsn = gWal.enabled() ? gWal.logImage(name_, 0, meta.raw()) : 0;
+        bf_.writePage(0, meta, lsn);
+    } else {
+        schema_ = readSchema();
     }
-    return out;
+    if (schema_.pageLayout() == PageLayout::Pax) pax_ = std::make_unique<PaxLayout>(schema_);
+    if (!create) openIndexes();
 }
 
-std::vector<std::string>
-TableFile::deserializeRow(const char* data, uint16_t len)
+TableFile::TableFile(const std::string& t, Access access)
+    : name_(t), bf_(t + ".tbl", false, access), schema_(readSchema())
 {
-    std::vector<std::string> out;
-    const char* end = data + len;                    // hard limit
+    if (schema_.pageLayout() == PageLayout::Pax) pax_ = std::make_unique<PaxLayout>(schema_);
+    openIndexes();
+}
+
+TableFile::~TableFile() = default;
 
-    if (data + sizeof(uint16_t) > end) return {};    // corrupt
+std::string TableFile::readCatalog() const
+{
+    std::string header;
+    if (const MappedFile* map = bf_.mapping()) {
+        if (map->pageCount() == 0) return {};
+        header.assign(map->page(0), ::strnlen(map->page(0), PAGE_SIZE));
+    } else {
+        auto g = gBufPool.fetch(bf_.id(), 0, Latch::Shared);
+        const char* raw = g.page().raw();
+        header.assign(raw, ::strnlen(raw, PAGE_SIZE));
+    }
+    return header;
+}
 
-    const char* ptr = data;
-    uint16_t colCnt = *reinterpret_cast<const uint16_t*>(ptr);
-    ptr += sizeof(uint16_t);
+Schema TableFile::readSchema() const
+{
+    return Schema::fromCatalog(readCatalog());
+}
 
-    while (colCnt--) {
-        if (ptr + sizeof(uint16_t) > end) return {}; // corrupt
-        uint16_t slen = *reinterpret_cast<const uint16_t*>(ptr);
-        ptr += sizeof(uint16_t);
-        if (ptr + slen > end) return {};             // corrupt
-        out.emplace_back(ptr, slen);
-        ptr += slen;
+void TableFile::openIndexes()
+{
+    std::string cat = readCatalog();
+    for (size_t nl = cat.find('\n'); nl != std::string::npos;) {
+        size_t      end  = cat.find('\n', nl + 1);
+        std::string line = cat.substr(nl + 1, end == std::string::npos ? end : end - nl - 1);
+        nl = end;
+
+        const IndexKind kind = line.rfind("hash:", 0) == 0 ? IndexKind::Hash : IndexKind::BTree;
+        const size_t    tag  = kind == IndexKind::Hash ? 5 : 6;
+        size_t colon = line.find(':', tag);
+        if ((kind == IndexKind::BTree && line.rfind("index:", 0) != 0) || colon == std::string::npos)
+            throw StorageError("corrupt catalog in " + bf_.path().string());
+        std::string ixName = line.substr(tag, colon - tag), column = line.substr(colon + 1);
+        size_t col = 0;
+        while (col < schema_.size() && schema_[col].name != column) ++col;
+        if (col == schema_.size()) throw StorageError("index " + ixName + ": no column " + column);
+
+        // not logged: after a replay (or a cut-short build) only a rebuild
+        // is sure to match the rows
+        std::unique_ptr<Index> ix;
+        if (!gWal.replayed(name_)) {
+            try {
+                ix = std::make_unique<Index>(name_, ixName, schema_, col, kind, false);
+            } catch (const StorageError&) {}
+        }
+        if (!ix) {
+            if (readOnly()) continue;                  // scans still answer every query
+            ix = std::make_unique<Index>(name_, ixName, schema_, col, kind, true);
+            buildIndex(*ix);
+        }
+        indexes_.push_back(std::move(ix));
     }
-    return out;
 }
 
-/* ─── TableFile ─────────────────────────────────────────────── */
+void TableFile::buildIndex(Index& ix)
+{
+    std::string batch;
+    TableScan   scan(*this);
+    RowRef      row;
+    while (scan.next(row)) ix.add(batch, row, scan.rid());
+    ix.insertBatch(batch, 0);
+}
 
-TableFile::TableFile(const std::string& t, bool create,
-                     const std::vector<std::string>& cols)
-    : bf_(t + ".tbl", create)
+void TableFile::createIndex(const std::string& n, const std::string& column, IndexKind kind)
 {
-    if (create) {
-        Page meta;
-        std::string hdr = "cols:";
-        for (size_t i = 0; i < cols.size(); ++i) {
-            hdr += cols[i];
-            if (i + 1 != cols.size()) hdr += ',';
+    if (readOnly()) throw StorageError("table is read-only");
+    if (n.empty() || n.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_")
+                         != std::string::npos)
+        throw StorageError("bad index name " + n);
+    size_t col = 0;
+    while (col < schema_.size() && schema_[col].name != column) ++col;
+    if (col == schema_.size()) throw ExecutionError("no column " + column);
+
+    auto gate = gWal.gate();                           // no rows slip in between build and catalog
+    std::scoped_lock lock(appendMtx_);
+    for (const auto& ix : indexes_)
+        if (ix->name() == n) throw StorageError("index " + n + " exists");
+
+    std::string cat = readCatalog() + (kind == IndexKind::Hash ? "\nhash:" : "\nindex:") + n + ":" + column;
+    if (cat.size() >= PAGE_SIZE) throw StorageError("too many indexes");
+
+    // a file the catalog does not list is left over from a crash: overwrite it
+    auto ix = std::make_unique<Index>(name_, n, schema_, col, kind, true);
+    buildIndex(*ix);
+
+    Page meta;
+    std::memcpy(meta.raw(), cat.data(), cat.size());
+    uint64_t lsn = gWal.enabled() ? gWal.logImage(name_, 0, meta.raw()) : 0;
+    bf_.writePage(0, meta, lsn);
+    indexes_.push_back(std::move(ix));
+}
+
+bool TableFile::readRecord(Rid rid, std::string& out) const
+{
+    auto copy = [&](const char* page) {
+        if (pax_ && PaxLayout::isPax(page)) {
+            if (rid.slot >= PaxLayout::rowCount(page)) return false;
+            pax_->row(page, rid.slot, out);
+            return true;
         }
-        std::memcpy(meta.raw(), hdr.data(), hdr.size());
-        bf_.writePage(0, meta);
+        if (rid.slot >= Page::recordCount(page)) return false;
+        uint16_t    len;
+        const char* rec = Page::record(page, rid.slot, len);
+        out.assign(rec, len);
+        return true;
+    };
+    if (rid.page == 0 || rid.page >= bf_.pageCount()) return false;
+    if (const MappedFile* map = bf_.mapping()) return copy(map->page(rid.page));
+    auto g = gBufPool.fetch(bf_.id(), rid.page, Latch::Shared);
+    return copy(g.page().raw());
+}
+
+void TableFile::formatPage(Page& pg) const
+{
+    if (pax_) pax_->format(pg.raw());
+    else      pg = Page();
+}
+
+int TableFile::place(Page& pg, const std::string& rec) const
+{
+    if (!pax_) return pg.insertRecord(rec);
+    return pax_->insert(pg.raw(), rec.data(), static_cast<uint16_t>(rec.size()));
+}
+
+uint64_t TableFile::logAppend(PageGuard& g, bool fresh, uint16_t slot, const std::string& rec)
+{
+    if (!gWal.enabled()) return 0;
+    uint32_t page = static_cast<uint32_t>(g.pageNo());
+    uint64_t lsn;
+    if (fresh) {                                       // Format + Insert rebuilds it
+        gWal.logFormat(name_, page, pax_ != nullptr);
+        lsn = gWal.logInsert(name_, page, slot, rec);
+    } else if (page != imagedPage_ || gWal.epoch() != imagedEpoch_) {
+        lsn = gWal.logImage(name_, page, g.page().raw());   // first touch since checkpoint
+    } else {
+        lsn = gWal.logInsert(name_, page, slot, rec);
+        g.setLsn(lsn);
+        return lsn;
     }
+    imagedPage_  = page;
+    imagedEpoch_ = gWal.epoch();
+    g.setLsn(lsn);
+    return lsn;
+}
+
+void TableFile::checkSize(const std::string& rec) const
+{
+    if (rec.size() > MAX_RECORD_SIZE) throw StorageError("row too large");
+    if (pax_ && pax_->textBytes(rec.data(), static_cast<uint16_t>(rec.size())) > pax_->maxText())
+        throw StorageError("row too large");
 }
 
 void TableFile::appendRow(const std::vector<std::string>& row)
 {
-    std::string bytes = serializeRow(row);
+    if (readOnly()) throw StorageError("table is read-only");
+    std::vector<std::string> recs(1);
+    schema_.encode(row, recs[0], Literal::Sql);
+    checkSize(recs[0]);
+    appendRecords(recs);
+}
 
-    size_t last = bf_.pageCount() - 1;
+void TableFile::appendRows(const std::vector<std::vector<std::string>>& rows)
+{
+    if (readOnly()) throw StorageError("table is read-only");
+    std::vector<std::string> recs(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {         // reject the batch before any write
+        schema_.encode(rows[i], recs[i], Literal::Sql);
+        checkSize(recs[i]);
+    }
+    appendRecords(recs);
+}
 
-    // page 0 is metadata – if it’s the only page, allocate page 1 first
-    if (last == 0) {
-        Page fresh;
-        if (fresh.insertRecord(bytes) == -1)
-            throw StorageError("row too large");
-        bf_.writePage(1, fresh);
-        return;
+void TableFile::appendRecords(const std::vector<std::string>& recs)
+{
+    auto gate = gWal.gate();                           // log + apply vs. checkpoint
+    std::scoped_lock lock(appendMtx_);
+
+    // page 0 is metadata – pin the current tail once, if there is one
+    if (!tail_ && bf_.pageCount() > 1)
+        tail_ = gBufPool.pinPage(bf_.id(), bf_.pageCount() - 1);
+
+    // where each row went, for the indexes once no page latch is held
+    struct Placed { Rid rid; uint64_t lsn; };
+    std::vector<Placed> placed;
+    auto note = [&](const PageGuard& g, int slot, uint64_t lsn) {
+        if (!indexes_.empty())
+            placed.push_back({{static_cast<uint32_t>(g.pageNo()), static_cast<uint16_t>(slot)}, lsn});
+    };
+
+    size_t i = 0;
+    if (tail_) {                                       // common case: no I/O
+        auto g = tail_.latch(Latch::Exclusive);
+        for (int slot; i < recs.size() && (slot = place(g.mutPage(), recs[i])) != -1; ++i)
+            note(g, slot, logAppend(g, false, static_cast<uint16_t>(slot), recs[i]));
     }
 
-    Page pg;
-    bf_.readPage(last, pg);
+    // tail full (or no data page yet) → roll to fresh pages
+    while (i < recs.size()) {
+        PagePin fresh = gBufPool.pinNew(bf_.id(), bf_.allocatePage());
+        {
+            auto g = fresh.latch(Latch::Exclusive);
+            if (pax_) formatPage(g.mutPage());        // pinNew hands out a slotted page
+            bool formatted = false;
+            for (int slot; i < recs.size() && (slot = place(g.mutPage(), recs[i])) != -1; ++i) {
+                note(g, slot, logAppend(g, !formatted, static_cast<uint16_t>(slot), recs[i]));
+                formatted = true;
+            }
+            // checkSize() let it through, but not even an empty page takes
+            // it: stop rather than allocate pages forever
+            if (!formatted) throw StorageError("row too large");
+        }
+        tail_ = std::move(fresh);                      // old tail left to the writer
+    }
 
-    if (pg.insertRecord(bytes) == -1) {        // full → add new page
-        Page fresh;
-        if (fresh.insertRecord(bytes) == -1)
-            throw StorageError("row too large");
-        bf_.writePage(last + 1, fresh);
-    } else {
-        bf_.writePage(last, pg);
+    // index pages carry the row's LSN: the log reaches disk before they do
+    for (size_t r = 0; r < placed.size(); ++r) {
+        RowRef row(schema_, recs[r].data(), static_cast<uint16_t>(recs[r].size()));
+        for (auto& ix : indexes_) ix->insert(row, placed[r].rid, placed[r].lsn);
+    }
+}
+
+size_t TableFile::bulkAppend(const std::function<bool(std::string&)>& next)
+{
+    constexpr size_t kRun = 64;                        // pages per pwritev
+
+    if (readOnly()) throw StorageError("table is read-only");
+
+    auto gate = gWal.gate();                           // no checkpoint mid-load
+    std::scoped_lock lock(appendMtx_);
+    tail_.release();                                   // appendRow re-pins the new last page
+
+    // data pages bypass the log: a durable begin record lets recovery cut
+    // the file back to `first` if the end record never made it
+    const size_t   first  = bf_.pageCount();
+    const bool     logged = gWal.enabled();
+    const uint64_t begin  = logged ? gWal.logBulk(name_, static_cast<uint32_t>(first), false) : 0;
+    if (logged) gWal.flushTo(begin);
+    std::vector<std::string> entries(indexes_.size());   // per index, applied once all rows are in
+
+    std::vector<Page>        run(kRun);
+    std::vector<const char*> bufs;
+    size_t      runFirst = first, used = 0, rows = 0;
+    std::string rec;
+    auto writeRun = [&] {
+        bufs.clear();
+        for (size_t i = 0; i < used; ++i) bufs.push_back(run[i].raw());
+        bf_.writeDirect(runFirst, bufs);
+        runFirst += used;
+        used = 0;
+    };
+
+    try {
+        while (next(rec)) {
+            checkSize(rec);
+            int slot = used == 0 ? -1 : place(run[used - 1], rec);
+            if (slot == -1) {
+                if (used == kRun) writeRun();
+                formatPage(run[used]);
+                bf_.allocatePage();
+                if ((slot = place(run[used++], rec)) == -1) throw StorageError("row too large");
+            }
+            if (!indexes_.empty()) {
+                RowRef row(schema_, rec.data(), static_cast<uint16_t>(rec.size()));
+                Rid    rid{static_cast<uint32_t>(runFirst + used - 1), static_cast<uint16_t>(slot)};
+                for (size_t k = 0; k < indexes_.size(); ++k) indexes_[k]->add(entries[k], row, rid);
+            }
+            ++rows;
+        }
+        if (used) writeRun();
+        if (logged && gWal.mode() != SyncMode::Off) bf_.sync();   // pages before the end record
+    } catch (...) {
+        bf_.truncatePages(first);
+        if (logged) gWal.logBulk(name_, static_cast<uint32_t>(first), true);
+        throw;
     }
+    if (logged) gWal.logBulk(name_, static_cast<uint32_t>(first), true);
+
+    // pages are in; a crash before the index pages are written shows up
+    // as this COPY in the log, and the replay rebuilds the indexes
+    for (size_t k = 0; k < indexes_.size(); ++k) indexes_[k]->insertBatch(entries[k], begin);
+    return rows;
 }
 
 void TableFile::loadAllRows(std::vector<std::vector<std::string>>& dest)
 {
-    for (size_t p = 1; p < bf_.pageCount(); ++p) {      // skip page-0
-        Page pg;
-        bf_.readPage(p, pg);
-        pg.forEachRecord([&](const char* rec, uint16_t len) {
-            dest.push_back(deserializeRow(rec, len));
-        });
+    TableScan scan(*this);
+    RowRef row;
+    while (scan.next(row)) {
+        auto& out = dest.emplace_back(row.size());
+        for (size_t i = 0; i < row.size(); ++i) row.format(i, out[i]);
     }
 }
 
-std::vector<std::string> TableFile::columnList() const
+/* ─── PageReader ────────────────────────────────────────────── */
+
+PageReader::PageReader(const BlockFile& bf)
+    : bf_(bf), map_(bf.mapping()), end_(map_ ? map_->pageCount() : bf.pageCount())
 {
-    Page meta;
-    bf_.readPage(0, meta);
-    std::string header(meta.raw(), PAGE_SIZE);
-    auto pos = header.find("cols:");
-    if (pos == std::string::npos) return {};
-    std::string list = header.substr(pos + 5);        // after "cols:"
-    list.erase(std::find_if(list.begin(), list.end(), [](char c){ return c==0; }), list.end());
-    std::vector<std::string> cols;
-    std::string token;
-    std::istringstream ss(list);
-    while (std::getline(ss, token, ',')) cols.push_back(token);
-    return cols;
+    if (map_) map_->adviseSequential();
+    else      gBufPool.adviseSequential(bf_.id(), next_);
+}
+
+PageReader::PageReader(const BlockFile& bf, size_t first, size_t end)
+    : bf_(bf), map_(bf.mapping()), next_(std::max<size_t>(first, 1)),
+      end_(std::min(end, map_ ? map_->pageCount() : bf.pageCount()))
+{
+    if (next_ >= end_) return;
+    if (map_) map_->adviseSequential();
+    else      gBufPool.adviseSequential(bf_.id(), next_);
+}
+
+const char* PageReader::next()
+{
+    if (next_ >= end_) return nullptr;
+    if (map_) return map_->page(next_++);
+    bf_.readPage(next_++, copy_);
+    return copy_.raw();
+}
+
+/* ─── TableScan ─────────────────────────────────────────────── */
+
+TableScan::TableScan(TableFile& tf, const Predicate* where)
+    : schema_(tf.schema()), pax_(tf.pax()), where_(where), pages_(tf.bf())
+{
+    init();
+}
+
+TableScan::TableScan(TableFile& tf, const Predicate* where, size_t first, size_t end)
+    : schema_(tf.schema()), pax_(tf.pax()), where_(where), pages_(tf.bf(), first, end)
+{
+    init();
+}
+
+void TableScan::init()
+{
+    if (!pax_ || !where_) return;
+    std::vector<size_t> cols;                           // just what the predicate reads
+    where_->columns(cols);
+    std::sort(cols.begin(), cols.end());
+    cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+    batch_.emplace(schema_, pax_, std::move(cols));
+    mask_.resize(simd::maskWords(ColumnScan::kMaxRows));
+    sel_.resize(ColumnScan::kMaxRows);
+}
+
+bool TableScan::next(const char*& rec, uint16_t& len)
+{
+    for (;;) {
+        while (slot_ == slots_) {                      // current page done
+            if (!(page_ = pages_.next())) return false;
+            paxPage_ = pax_ && PaxLayout::isPax(page_);
+            slot_    = 0;
+            if (paxPage_ && batch_) {                   // the whole page at once
+                batch_->load(page_);
+                where_->matchBatch(*batch_, mask_.data());
+                slots_ = static_cast<uint16_t>(
+                    simd::toSelection(mask_.data(), batch_->rows(), sel_.data()));
+            } else {
+                slots_ = paxPage_ ? PaxLayout::rowCount(page_) : Page::recordCount(page_);
+            }
+        }
+        uint16_t s = batch_ && paxPage_ ? sel_[slot_++] : slot_++;
+        last_ = s;
+        if (paxPage_) {
+            if (where_ && !batch_ && !where_->matches(PaxRow(*pax_, page_, s))) continue;
+            pax_->row(page_, s, row_);
+            rec = row_.data();
+            len = static_cast<uint16_t>(row_.size());
+            return true;
+        }
+        rec = Page::record(page_, s, len);
+        if (where_ && !(schema_.valid(rec, len) && where_->matches(RowRef(schema_, rec, len))))
+            continue;
+        return true;
+    }
+}
+
+bool TableScan::next(RowRef& row)
+{
+    const char* rec;
+    uint16_t    len;
+    while (next(rec, len)) {
+        if (!schema_.valid(rec, len)) continue;         // skip corrupt records
+        row = RowRef(schema_, rec, len);
+        return true;
+    }
+    return false;
 }
 
+/* ─── ColumnScan ────────────────────────────────────────────── */
+
+ColumnScan::ColumnScan(TableFile& tf, std::vector<size_t> cols)
+    : ColumnScan(tf.schema(), tf.pax(), std::move(cols))
+{
+    pages_.emplace(tf.bf());
+}
+
+ColumnScan::ColumnScan(const Schema& schema, const PaxLayout* pax, std::vector<size_t> cols)
+    : schema_(schema), pax_(pax), cols_(std::move(cols)),
+      slot_(schema_.size(), -1), cells_(cols_.size()), nulls_(cols_.size()), text_(cols_.size())
+{
+    for (size_t k = 0; k < cols_.size(); ++k) {
+        if (cols_[k] >= schema_.size()) throw StorageError("no column " + std::to_string(cols_[k]));
+        slot_[cols_[k]] = static_cast<int>(k);
+    }
+}
+
+bool ColumnScan::next()
+{
+    const char* page;
+    do {
+        if (!pages_ || !(page = pages_->next())) return false;
+        load(page);
+    } while (rows_ == 0);
+    return true;
+}
+
+void ColumnScan::load(const char* page)
+{
+    page_    = page;
+    paxPage_ = pax_ && PaxLayout::isPax(page_);
+    if (paxPage_) rows_ = PaxLayout::rowCount(page_);
+    else          gather();
+}
+
+void ColumnScan::gather()
+{
+    uint16_t n = Page::recordCount(page_);
+    for (size_t k = 0; k < cols_.size(); ++k) {
+        const Column& c = schema_[cols_[k]];
+        size_t width = c.type == ColType::Bool ? 1 : c.type == ColType::Char ? c.width : 8;
+        cells_[k].assign((n * width + 7) / 8, 0);
+        nulls_[k].assign((n + 7) / 8, 0);
+        text_[k].clear();
+    }
+
+    rows_ = 0;
+    for (uint16_t s = 0; s < n; ++s) {
+        uint16_t    len;
+        const char* rec = Page::record(page_, s, len);
+        if (!schema_.valid(rec, len)) continue;         // skip corrupt records
+        RowRef row(schema_, rec, len);
+        for (size_t k = 0; k < cols_.size(); ++k) {
+            size_t        i = cols_[k];
+            const Column& c = schema_[i];
+            if (row.isNull(i)) {
+                nulls_[k][rows_ >> 3] |= static_cast<uint8_t>(1 << (rows_ & 7));
+                if (c.type == ColType::Text || c.type == ColType::Char) text_[k].emplace_back();
+                continue;
+            }
+            auto* cells = reinterpret_cast<char*>(cells_[k].data());
+            switch (c.type) {
+            case ColType::Int64:
+            case ColType::Double:
+            case ColType::Bool:
+                std::memcpy(cells + size_t(rows_) * (c.type == ColType::Bool ? 1 : 8),
+                            rec + schema_.offset(i), c.type == ColType::Bool ? 1 : 8);
+                break;
+            case ColType::Char:
+                std::memcpy(cells + size_t(rows_) * c.width, rec + schema_.offset(i), c.width);
+                [[fallthrough]];
+            case ColType::Text:
+                text_[k].push_back(row.getText(i));
+                break;
+            }
+        }
+        ++rows_;
+    }
+}
+
+const char* ColumnScan::cells(size_t k) const
+{
+    if (paxPage_) return pax_->cells(page_, cols_[k]);
+    return reinterpret_cast<const char*>(cells_[k].data());
+}
+
+const uint8_t* ColumnScan::nulls(size_t k) const
+{
+    if (paxPage_) return pax_->nulls(page_, cols_[k]);
+    return nulls_[k].data();
+}
+
+std::string_view ColumnScan::text(size_t k, uint16_t r) const
+{
+    if (paxPage_) return pax_->isNull(page_, cols_[k], r) ? std::string_view()
+                                                          : pax_->text(page_, cols_[k], r);
+    return text_[k][r];
+}
 
 /* ─── FileManager ───────────────────────────────────────────── */
 
 void FileManager::createTable(const std::string& n,
-                              const std::vector<std::string>& cols)
+                              const std::vector<std::string>& cols, PageLayout layout)
 {
+    if (access_ == Access::ReadOnly) throw StorageError("database is read-only");
     if (fs::exists(n + ".tbl")) throw StorageError("exists");
-    open_[n] = std::make_unique<TableFile>(n, true, cols);
+    Schema s = Schema::fromDefs(cols);                 // bad types: fail before the file exists
+    s.setPageLayout(layout);
+    if (layout == PageLayout::Pax) PaxLayout{s};       // … and rows no PAX page can hold
+    open_[n] = std::make_unique<TableFile>(n, true, cols, layout);
 }
 
 elvoiddb::storage::TableFile* FileManager::openTable(const std::string& n)
 {
     if (auto it = open_.find(n); it != open_.end()) return it->second.get();
     if (!fs::exists(n + ".tbl")) return nullptr;
-    open_[n] = std::make_unique<TableFile>(n, false);
+    open_[n] = std::make_unique<TableFile>(n, access_);
     return open_[n].get();
 }
 
+void FileManager::closeAll()
+{
+    open_.clear();
+}
+
 } // namespace elvoiddb::storage
@@ -1,5 +1,146 @@
 #include "ThreadPool.hpp"
+#include <utility>
 
 namespace elvoiddb::util {
 ThreadPool gThreadPool;          // default size = hardware_concurrency
+
+namespace {
+constexpr int kSpins = 16;                      // idle rounds before a worker sleeps
+thread_local ThreadPool* tlsPool  = nullptr;    // the pool this thread works for
+thread_local size_t      tlsIndex = 0;
+} // namespace
+
+/* ─── ThreadPool ────────────────────────────────────────────── */
+
+ThreadPool::ThreadPool(size_t n)
+{
+    if (n == 0) n = 1;                           // hardware_concurrency may not know
+    for (size_t i = 0; i < n; ++i) queues_.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < n; ++i) workers_.emplace_back([this, i] { worker(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(sleepMtx_);
+        shutdown_ = true;
+    }
+    wake_.notify_all();
+    for (auto& w : workers_) w.join();
+}
+
+void ThreadPool::push(Task t)
+{
+    const size_t q = tlsPool == this ? tlsIndex : deal_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard lock(queues_[q]->mtx);
+        queues_[q]->tasks.push_back(std::move(t));
+        queues_[q]->size.store(queues_[q]->tasks.size(), std::memory_order_relaxed);
+    }
+    pending_.fetch_add(1);
+    // a worker counts itself a sleeper before it checks pending_, so one
+    // of the two sees the other; a sleeper already notified needs no
+    // second futex wake while it waits to be scheduled
+    if (sleepers_.load() > woken_.load()) {
+        std::lock_guard lock(sleepMtx_);
+        if (sleepers_.load() > woken_.load()) {
+            woken_.fetch_add(1);
+            wake_.notify_one();
+        }
+    }
+}
+
+bool ThreadPool::pop(size_t self, Task& t)
+{
+    const size_t n = queues_.size();
+    auto take = [&](Queue& q, bool back) {
+        if (q.tasks.empty()) return false;
+        t = std::move(back ? q.tasks.back() : q.tasks.front());
+        if (back) q.tasks.pop_back();
+        else      q.tasks.pop_front();
+        q.size.store(q.tasks.size(), std::memory_order_relaxed);
+        pending_.fetch_sub(1);
+        return true;
+    };
+    if (self < n) {                              // own deque: newest first
+        Queue& q = *queues_[self];
+        std::lock_guard lock(q.mtx);
+        if (take(q, true)) return true;
+    }
+    // steal the oldest from the others; an empty or busy deque is
+    // skipped rather than waited for
+    const size_t from = self < n ? self + 1 : deal_.load(std::memory_order_relaxed);
+    for (size_t k = 0; k < n; ++k) {
+        const size_t i = (from + k) % n;
+        Queue&       q = *queues_[i];
+        if (i == self || q.size.load(std::memory_order_relaxed) == 0) continue;
+        std::unique_lock lock(q.mtx, std::try_to_lock);
+        if (lock && take(q, false)) return true;
+    }
+    return false;
+}
+
+bool ThreadPool::runOne()
+{
+    Task t;
+    if (!pop(tlsPool == this ? tlsIndex : queues_.size(), t)) return false;
+    t();
+    return true;
+}
+
+void ThreadPool::worker(size_t i)
+{
+    tlsPool  = this;
+    tlsIndex = i;
+    for (Task t;;) {
+        // a few yields before sleeping: a burst of posts usually has more
+        // coming, and a futex sleep and wake costs more than the wait
+        bool got = pop(i, t);
+        for (int spin = 0; !got && spin < kSpins && !shutdown_; ++spin) {
+            std::this_thread::yield();
+            got = pop(i, t);
+        }
+        if (got) {
+            t();
+            t.reset();                           // captures go before the next wait
+            continue;
+        }
+        std::unique_lock lock(sleepMtx_);
+        sleepers_.fetch_add(1);
+        while (!shutdown_ && pending_.load() <= 0) {
+            wake_.wait(lock);
+            if (woken_.load() != 0) woken_.fetch_sub(1);
+        }
+        sleepers_.fetch_sub(1);
+        if (shutdown_ && pending_.load() <= 0) return;
+    }
+}
+
+/* ─── TaskGroup ─────────────────────────────────────────────── */
+
+TaskGroup::~TaskGroup()
+{
+    try { wait(); } catch (...) {}
+}
+
+void TaskGroup::finish(std::exception_ptr e)
+{
+    // under the lock: wait() takes it before returning, so the group
+    // outlives this call
+    std::lock_guard lock(mtx_);
+    if (e && !error_) error_ = e;
+    if (pending_.fetch_sub(1) == 1) done_.notify_all();
+}
+
+void TaskGroup::wait()
+{
+    while (pending_.load() != 0) {
+        if (pool_.runOne()) continue;            // help rather than block
+        std::unique_lock lock(mtx_);
+        done_.wait(lock, [&] { return pending_.load() == 0; });
+    }
+    std::lock_guard lock(mtx_);
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
+
 } // namespace elvoiddb::util
@@ -0,0 +1,35 @@
+#include "VectorScan.hpp"
+#include <algorithm>
+
+namespace elvoiddb::storage {
+
+std::vector<size_t> VectorScan::scanned(std::vector<size_t> cols, const Predicate* where)
+{
+    if (where) where->columns(cols);
+    std::sort(cols.begin(), cols.end());
+    cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+    return cols;
+}
+
+VectorScan::VectorScan(TableFile& tf, std::vector<size_t> cols, const Predicate* where)
+    : where_(where), scan_(tf, scanned(std::move(cols), where)),
+      mask_(simd::maskWords(ColumnScan::kMaxRows)), sel_(ColumnScan::kMaxRows)
+{}
+
+bool VectorScan::next()
+{
+    while (scan_.next()) {
+        const uint16_t n = scan_.rows();
+        if (!where_) {                                 // identity selection
+            for (uint16_t r = 0; r < n; ++r) sel_[r] = r;
+            selected_ = n;
+            return true;
+        }
+        where_->matchBatch(scan_, mask_.data());
+        selected_ = static_cast<uint16_t>(simd::toSelection(mask_.data(), n, sel_.data()));
+        if (selected_) return true;
+    }
+    return false;
+}
+
+} // namespace elvoiddb::storage
@@ -0,0 +1,397 @@
+#include "Wal.hpp"
+#include "BufferPool.hpp"
+#include "FileHandle.hpp"
+#include "Page.hpp"
+#include "PaxPage.hpp"
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <unordered_map>
+#include <unistd.h>
+
+namespace elvoiddb::storage {
+
+Wal gWal;
+
+SyncMode parseSyncMode(const std::string& name)
+{
+    if (name == "off")    return SyncMode::Off;
+    if (name == "normal") return SyncMode::Normal;
+    if (name == "full")   return SyncMode::Full;
+    throw StorageError("unknown sync mode " + name);
+}
+
+const char* syncModeName(SyncMode m)
+{
+    switch (m) {
+    case SyncMode::Off:    return "off";
+    case SyncMode::Normal: return "normal";
+    case SyncMode::Full:   return "full";
+    }
+    return "?";
+}
+
+namespace {
+
+enum RecType : uint8_t { RecFormat = 1, RecImage = 2, RecInsert = 3, RecBulk = 4 };
+
+constexpr size_t kHeader    = 2 * sizeof(uint32_t);   // body length, crc32(body)
+constexpr size_t kMaxRecord = 1u << 20;
+
+thread_local uint64_t tLastLsn = 0;                   // last record this thread appended
+
+uint32_t crc32(const char* p, size_t n)
+{
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) c = table[(c ^ static_cast<uint8_t>(p[i])) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+template <typename T> void put(std::string& out, T v)
+{
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T> bool get(const char*& p, const char* end, T& v)
+{
+    if (p + sizeof(T) > end) return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+} // namespace
+
+/* ─── lifecycle ─────────────────────────────────────────────── */
+
+Wal::~Wal()
+{
+    stopWriter();
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void Wal::open(const fs::path& path, SyncMode mode)
+{
+    if (enabled()) throw StorageError("log already open");
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) throw StorageError("cannot open log " + path.string() + ": " + std::strerror(errno));
+    path_ = path;
+    mode_ = mode;
+    fd_   = fd;
+    replay();                                        // pages go to the pool; checkpoint persists them
+    stop_   = false;
+    writer_ = std::thread([this] { run(); });
+    gBufPool.setLogFlush([](uint64_t lsn) { gWal.flushTo(lsn); });
+    checkpoint();
+}
+
+void Wal::close()
+{
+    if (!enabled()) return;
+    checkpoint();
+    gBufPool.setLogFlush(nullptr);
+    stopWriter();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void Wal::stopWriter()
+{
+    if (!writer_.joinable()) return;
+    {
+        std::scoped_lock lock(mtx_);
+        stop_ = true;
+    }
+    work_.notify_one();
+    writer_.join();
+}
+
+/* ─── appending ─────────────────────────────────────────────── */
+
+uint64_t Wal::append(uint8_t type, const std::string& table, uint32_t page,
+                     uint16_t slot, const char* data, size_t len)
+{
+    std::string body;
+    body.reserve(32 + table.size() + len);
+    std::scoped_lock lock(mtx_);
+    uint64_t lsn = nextLsn_++;
+    put(body, lsn);
+    put(body, type);
+    put(body, static_cast<uint16_t>(table.size()));
+    body += table;
+    put(body, page);
+    put(body, slot);
+    put(body, static_cast<uint32_t>(len));
+    body.append(data, len);
+
+    put(buf_, static_cast<uint32_t>(body.size()));
+    put(buf_, crc32(body.data(), body.size()));
+    buf_ += body;
+    stats_.records++;
+    tLastLsn = lsn;
+    if (buf_.size() >= kMaxRecord) work_.notify_one();   // keep the buffer bounded
+    return lsn;
+}
+
+uint64_t Wal::logFormat(const std::string& table, uint32_t page, bool pax)
+{
+    return append(RecFormat, table, page, pax ? 1 : 0, nullptr, 0);
+}
+
+uint64_t Wal::logImage(const std::string& table, uint32_t page, const char* image)
+{
+    return append(RecImage, table, page, 0, image, PAGE_SIZE);
+}
+
+uint64_t Wal::logInsert(const std::string& table, uint32_t page, uint16_t slot,
+                        const std::string& rec)
+{
+    return append(RecInsert, table, page, slot, rec.data(), rec.size());
+}
+
+uint64_t Wal::logBulk(const std::string& table, uint32_t firstPage, bool end)
+{
+    return append(RecBulk, table, firstPage, end ? 1 : 0, nullptr, 0);
+}
+
+/* ─── commit / flush ────────────────────────────────────────── */
+
+void Wal::waitFor(uint64_t lsn, bool sync)
+{
+    std::unique_lock lock(mtx_);
+    if (sync) syncWant_  = std::max(syncWant_, lsn);
+    else      writeWant_ = std::max(writeWant_, lsn);
+    work_.notify_one();
+    done_.wait(lock, [&] { return stop_ || (sync ? syncedLsn_ : writtenLsn_) >= lsn; });
+    if ((sync ? syncedLsn_ : writtenLsn_) < lsn) throw StorageError("log writer stopped");
+}
+
+void Wal::commit()
+{
+    if (!enabled() || tLastLsn == 0) return;
+    {
+        std::scoped_lock lock(mtx_);
+        stats_.commits++;
+    }
+    if (mode_ == SyncMode::Normal) waitFor(tLastLsn, false);
+    if (mode_ == SyncMode::Full)   waitFor(tLastLsn, true);
+}
+
+void Wal::flushTo(uint64_t lsn)
+{
+    if (!enabled() || lsn == 0 || mode_ == SyncMode::Off) return;
+    waitFor(lsn, true);
+}
+
+/* ─── log writer: one write (+ one fdatasync) per batch ────────
+   Commits that arrive while a sync is running pile up in buf_ and all
+   share the next one – that is the group commit.                     */
+void Wal::run()
+{
+    std::unique_lock lock(mtx_);
+    for (;;) {
+        work_.wait_for(lock, std::chrono::milliseconds(100), [&] {
+            return stop_ || writeWant_ > writtenLsn_ || syncWant_ > syncedLsn_;
+        });
+        if (buf_.empty() && syncWant_ <= syncedLsn_) {
+            writtenLsn_ = nextLsn_ - 1;              // everything appended is in the file
+            done_.notify_all();
+            if (stop_) break;
+            continue;
+        }
+
+        std::string out;
+        out.swap(buf_);
+        uint64_t upto = nextLsn_ - 1;
+        bool     sync = syncWant_ > syncedLsn_;
+        uint64_t off  = fileOff_;
+        fileOff_ += out.size();
+        writing_  = true;
+        lock.unlock();
+
+        bool ok = true;
+        for (size_t done = 0; done < out.size();) {
+            ssize_t r = ::pwrite(fd_, out.data() + done, out.size() - done, off + done);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) { ok = false; break; }
+            done += r;
+        }
+        if (ok && sync && ::fdatasync(fd_) != 0) ok = false;
+
+        lock.lock();
+        writing_ = false;
+        if (!ok) {                                   // waiters see stop_ and throw
+            stop_ = true;
+            done_.notify_all();
+            break;
+        }
+        writtenLsn_ = upto;
+        if (sync) { syncedLsn_ = upto; stats_.syncs++; }
+        done_.notify_all();
+    }
+}
+
+/* ─── checkpoint ────────────────────────────────────────────── */
+
+void Wal::checkpoint()
+{
+    if (!enabled()) return;
+    std::unique_lock gate(gate_);                    // no appender mid "log + apply"
+
+    uint64_t last;
+    {
+        std::scoped_lock lock(mtx_);
+        last = nextLsn_ - 1;
+    }
+    if (last) waitFor(last, mode_ != SyncMode::Off); // log first (and buf_ drained)
+    gBufPool.flushAll();                             // then the data pages
+    if (mode_ != SyncMode::Off) gHandles.syncAll();
+
+    std::unique_lock lock(mtx_);
+    done_.wait(lock, [&] { return !writing_; });
+    if (::ftruncate(fd_, 0) != 0) throw StorageError("cannot truncate log " + path_.string());
+    fileOff_ = 0;                                    // the file is empty either way
+    if (mode_ != SyncMode::Off && ::fdatasync(fd_) != 0)
+        throw StorageError("cannot sync log " + path_.string());
+    stats_.checkpoints++;
+    epoch_++;                                        // pages need a fresh image again
+}
+
+void Wal::maybeCheckpoint()
+{
+    if (!enabled()) return;
+    {
+        std::scoped_lock lock(mtx_);
+        if (fileOff_ + buf_.size() < kCheckpointBytes) return;
+    }
+    checkpoint();
+}
+
+Wal::Stats Wal::stats() const
+{
+    std::scoped_lock lock(mtx_);
+    return stats_;
+}
+
+/* ─── recovery ──────────────────────────────────────────────── */
+
+void Wal::replay()
+{
+    std::string log;
+    {
+        char chunk[1 << 16];
+        for (off_t off = 0;;) {
+            ssize_t r = ::pread(fd_, chunk, sizeof chunk, off);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) throw StorageError("cannot read log " + path_.string());
+            if (r == 0) break;
+            log.append(chunk, r);
+            off += r;
+        }
+    }
+
+    std::unordered_map<std::string, FileId>   files;
+    std::unordered_map<std::string, uint32_t> bulk;      // COPYs with no end record
+    auto fileFor = [&](const std::string& table) {
+        auto it = files.find(table);
+        if (it != files.end()) return it->second;
+        fs::path p = table + ".tbl";
+        FileId id = gHandles.open(p, !fs::exists(p));    // created after the last checkpoint
+        files.emplace(table, id);
+        return id;
+    };
+    struct PaxTable { Schema schema; std::unique_ptr<PaxLayout> pax; };
+    std::unordered_map<std::string, std::unique_ptr<PaxTable>> layouts;
+    auto paxFor = [&](const std::string& table) -> const PaxLayout* {   // nullptr: slotted
+        auto it = layouts.find(table);
+        if (it == layouts.end()) {
+            auto t = std::make_unique<PaxTable>();
+            {
+                auto g = gBufPool.fetch(fileFor(table), 0, Latch::Shared);   // catalog came first
+                const char* raw = g.page().raw();
+                t->schema = Schema::fromCatalog(std::string_view(raw, ::strnlen(raw, PAGE_SIZE)));
+            }
+            if (t->schema.pageLayout() == PageLayout::Pax)
+                t->pax = std::make_unique<PaxLayout>(t->schema);
+            it = layouts.emplace(table, std::move(t)).first;
+        }
+        return it->second->pax.get();
+    };
+
+    const char* p   = log.data();
+    const char* end = p + log.size();
+    while (p + kHeader <= end) {
+        uint32_t len, crc;
+        std::memcpy(&len, p, sizeof len);
+        std::memcpy(&crc, p + sizeof len, sizeof crc);
+        const char* body = p + kHeader;
+        if (len > kMaxRecord + PAGE_SIZE || body + len > end || crc32(body, len) != crc)
+            break;                                   // torn tail: stop here
+        p = body + len;
+
+        const char* q    = body;
+        const char* bend = body + len;
+        uint64_t lsn; uint8_t type; uint16_t nameLen, slot; uint32_t page, dataLen;
+        if (!get(q, bend, lsn) || !get(q, bend, type) || !get(q, bend, nameLen) ||
+            q + nameLen > bend)
+            break;
+        std::string table(q, nameLen);
+        q += nameLen;
+        if (!get(q, bend, page) || !get(q, bend, slot) || !get(q, bend, dataLen) ||
+            q + dataLen > bend)
+            break;
+        nextLsn_ = std::max(nextLsn_, lsn + 1);
+        replayed_.insert(table);
+
+        if (type == RecBulk) {                       // pages themselves were never logged
+            if (slot) bulk.erase(table);
+            else      bulk[table] = page;
+            continue;
+        }
+        const PaxLayout* pax = (type == RecInsert || (type == RecFormat && slot)) && page != 0
+                                   ? paxFor(table) : nullptr;   // before latching `page`
+        auto g = gBufPool.fetch(fileFor(table), page, Latch::Exclusive);
+        if (pax) {                                   // PAX data page: row = slot
+            char* raw = g.mutPage().raw();
+            if (type == RecFormat || !PaxLayout::isPax(raw)) pax->format(raw);   // or never written
+            if (type == RecInsert && PaxLayout::rowCount(raw) == slot)
+                pax->insert(raw, q, static_cast<uint16_t>(dataLen));
+            continue;
+        }
+        switch (type) {
+        case RecFormat:
+            g.mutPage() = Page();
+            break;
+        case RecImage:
+            if (dataLen == PAGE_SIZE) std::memcpy(g.mutPage().raw(), q, PAGE_SIZE);
+            break;
+        case RecInsert: {
+            PageHeader h;
+            std::memcpy(&h, g.page().raw(), sizeof h);
+            if (h.freeOffset == 0) { g.mutPage() = Page(); h.slotCount = 0; }   // never written
+            if (h.slotCount == slot)                 // otherwise already applied
+                g.mutPage().insertRecord(std::string(q, dataLen));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    for (const auto& [table, first] : bulk)          // interrupted COPY: drop its pages
+        gHandles.get(fileFor(table))->truncate(first);
+}
+
+} // namespace elvoiddb::storage
@@ -1,11 +1,36 @@
 #include "Parser.hpp"
 #include "BufferPool.hpp"
+#include "Wal.hpp"
+#include <cstring>
 #include <iostream>
 
 using elvoiddb::Parser;
 using elvoiddb::AstroDBException;
 
-int main() {
+int main(int argc, char** argv) {
+    namespace st = elvoiddb::storage;
+    st::SyncMode sync = st::SyncMode::Normal;
+    bool readOnly = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--readonly") == 0) {
+                readOnly = true;
+            } else if (std::strncmp(argv[i], "--sync=", 7) == 0) {
+                sync = st::parseSyncMode(argv[i] + 7);
+            } else {
+                std::cerr << "usage: elvoiddb [--readonly] [--sync=off|normal|full]\n";
+                return 1;
+            }
+        }
+        // crash recovery: replay the log before any table is opened
+        st::gWal.open("elvoiddb.wal", sync);
+    } catch (const AstroDBException& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    // reporting mode: tables are mmap'd, scans skip the buffer pool
+    if (readOnly) elvoiddb::gFileMgr.setAccess(st::Access::ReadOnly);
+
     std::cout << "ElVoidDB> ";
     std::string line;
 
@@ -22,7 +47,9 @@ int main() {
 
         std::cout << "ElVoidDB> ";
     }
-    elvoiddb::storage::gBufPool.flushAll();
+    elvoiddb::gFileMgr.closeAll();
+    st::gWal.close();                            // final checkpoint: empty log
+    st::gBufPool.flushAll();
     std::cout << "Bye from ElVoidDB!\n";
     return 0;
 }